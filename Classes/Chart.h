@@ -46,6 +46,9 @@
 @property (nonatomic, retain) NSSet* series;
 @property (nonatomic, retain) NSDate* loadDate;
 
+// When the chart was last shown, see ChartBudget.
+@property (nonatomic, retain) NSDate* viewDate;
+
 @end
 
 
@@ -41,5 +41,6 @@
 @dynamic place;
 @dynamic series;
 @dynamic loadDate;
+@dynamic viewDate;
 
 @end
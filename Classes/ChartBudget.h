@@ -0,0 +1,70 @@
+//
+//  ChartBudget.h
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import <Foundation/Foundation.h>
+
+@class Chart;
+
+// Keeps chart data in the rootContext within a memory budget, and charts in the store within a
+// disk budget.
+//
+// ChartDataset values of charts other than the most recently shown one are turned back into
+// faults, least recently shown chart first, once they add up to more than maxResidentBytes, and
+// all of them on a memory warning. Charts of places that are not favourites and whose chart has
+// not been shown for maxUnviewedDays are deleted from the store.
+@interface ChartBudget : NSObject
+{
+	NSMutableArray* _recentCharts;	// NSManagedObjectIDs, most recently shown first
+	NSOperationQueue* _queue;	// saves view dates
+	NSUInteger _maxResidentBytes;
+	NSUInteger _maxUnviewedDays;
+}
+
+@property (nonatomic, assign) NSUInteger maxResidentBytes;
+@property (nonatomic, assign) NSUInteger maxUnviewedDays;
+
++ (ChartBudget*)sharedBudget;
+
+// Call on the main thread whenever a chart is displayed. The view date is saved in the background.
+- (void)chartWillBeShown:(Chart*)chart;
+
+// Estimated bytes of ChartDataset values resident in the rootContext.
+- (NSUInteger)residentBytes;
+
+// Turns chart data back into faults until no more than maxBytes are resident, sparing the most
+// recently shown chart.
+- (void)trimToBytes:(NSUInteger)maxBytes;
+
+// Trims to maxResidentBytes. Call after faulting in chart data that is not being shown.
+- (void)trimToBudget;
+
+// Deletes charts not shown for maxUnviewedDays, except those of favourite places.
+- (void)evictUnviewedCharts;
+
+@end
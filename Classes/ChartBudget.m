@@ -0,0 +1,260 @@
+//
+//  ChartBudget.m
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import <UIKit/UIKit.h>
+#import <CoreData/CoreData.h>
+
+#import "ChartBudget.h"
+#import "Chart.h"
+#import "ChartSeries.h"
+#import "ChartDataset.h"
+#import "ChartValue.h"
+#import "Place.h"
+#import "Favourites.h"
+#import "DataManager.h"
+#import "NSManagedObjectContext+Helpers.h"
+
+
+static const NSUInteger kDefaultMaxResidentBytes = 512 * 1024;
+static const NSUInteger kDefaultMaxUnviewedDays = 60;
+// A ChartValue object plus its slot in the values array
+static const NSUInteger kBytesPerChartValue = 32 + sizeof(id);
+// viewDate is only saved again when it is this old, so browsing does not save on every view
+static const NSTimeInterval kViewDateResolution = 24 * 60 * 60;
+
+
+@interface ChartBudget ()	// private
+
+- (void)didReceiveMemoryWarning:(NSNotification*)notification;
+- (NSDictionary*)residentBytesByChart;
+
+// Run on the queue
+- (void)saveViewDateOfChartWithID:(NSManagedObjectID*)chartID;
+
+@end
+
+
+@implementation ChartBudget
+
+@synthesize maxResidentBytes = _maxResidentBytes;
+@synthesize maxUnviewedDays = _maxUnviewedDays;
+
++ (ChartBudget*)sharedBudget
+{
+	static ChartBudget* budget = nil;
+	
+	if (budget == nil) {
+		budget = [[ChartBudget alloc] init];
+	}
+	return budget;
+}
+
+- (id)init
+{
+	assert([NSThread isMainThread]);
+	if ((self = [super init])) {
+		_recentCharts = [[NSMutableArray alloc] init];
+		_queue = [[NSOperationQueue alloc] init];
+		[_queue setMaxConcurrentOperationCount:1];
+		_maxResidentBytes = kDefaultMaxResidentBytes;
+		_maxUnviewedDays = kDefaultMaxUnviewedDays;
+		
+		[[NSNotificationCenter defaultCenter] addObserver:self
+												 selector:@selector(didReceiveMemoryWarning:)
+													 name:UIApplicationDidReceiveMemoryWarningNotification
+												   object:nil];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[_queue cancelAllOperations];
+	[_queue release];
+	[_recentCharts release];
+	[super dealloc];
+}
+
+- (void)chartWillBeShown:(Chart*)chart
+{
+	assert([NSThread isMainThread]);
+	if (!chart || [[chart objectID] isTemporaryID]) {
+		return;
+	}
+	[_recentCharts removeObject:[chart objectID]];
+	[_recentCharts insertObject:[chart objectID] atIndex:0];
+	
+	if (!chart.viewDate || -[chart.viewDate timeIntervalSinceNow] > kViewDateResolution) {
+		// Saved through the loader coordinator, and merged back into the rootContext like a
+		// loader's changes, so that showing a chart never saves the rootContext
+		[[DataManager manager] loaderStoreCoordinator];
+		NSInvocationOperation* operation = [[NSInvocationOperation alloc] initWithTarget:self
+																				selector:@selector(saveViewDateOfChartWithID:)
+																				  object:[chart objectID]];
+		[_queue addOperation:operation];
+		[operation release];
+	}
+	[self trimToBudget];
+}
+
+- (void)saveViewDateOfChartWithID:(NSManagedObjectID*)chartID
+{
+	NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+	
+	NSManagedObjectContext* context = [[[NSManagedObjectContext alloc] init] autorelease];
+	[context setPersistentStoreCoordinator:[[DataManager manager] loaderStoreCoordinator]];
+	// A loader may be replacing the chart meanwhile; its changes win
+	[context setMergePolicy:NSMergeByPropertyStoreTrumpMergePolicy];
+	NSError* error = nil;
+	Chart* chart = (Chart*)[context existingObjectWithID:chartID error:&error];
+	if (chart) {
+		chart.viewDate = [NSDate date];
+		[context saveAndLogErrors];
+	}
+	
+	[pool release];
+}
+
+- (NSDictionary*)residentBytesByChart
+{
+	NSMutableDictionary* result = [NSMutableDictionary dictionary];
+	for (NSManagedObject* object in [[[DataManager manager] rootContext] registeredObjects]) {
+		if ([object isKindOfClass:[ChartDataset class]] && ![object isFault]) {
+			ChartDataset* dataset = (ChartDataset*)object;
+			NSManagedObjectID* chartID = [dataset.series.chart objectID];
+			if (chartID) {
+				NSUInteger bytes = [[result objectForKey:chartID] unsignedIntegerValue];
+				bytes += [dataset.values count] * kBytesPerChartValue;
+				[result setObject:[NSNumber numberWithUnsignedInteger:bytes] forKey:chartID];
+			}
+		}
+	}
+	return result;
+}
+
+- (NSUInteger)residentBytes
+{
+	NSUInteger total = 0;
+	for (NSNumber* bytes in [[self residentBytesByChart] allValues]) {
+		total += [bytes unsignedIntegerValue];
+	}
+	return total;
+}
+
+- (void)trimToBytes:(NSUInteger)maxBytes
+{
+	assert([NSThread isMainThread]);
+	NSManagedObjectContext* context = [[DataManager manager] rootContext];
+	NSDictionary* bytesByChart = [self residentBytesByChart];
+	NSUInteger total = 0;
+	for (NSNumber* bytes in [bytesByChart allValues]) {
+		total += [bytes unsignedIntegerValue];
+	}
+#ifdef CHART_MEMORY_LOGGING
+	NSLog(@"Chart data resident: %lu bytes in %lu charts, budget %lu",
+		  (unsigned long)total, (unsigned long)[bytesByChart count], (unsigned long)maxBytes);
+#endif
+	if (total <= maxBytes) {
+		return;
+	}
+	
+	// Charts never shown go first, then the least recently shown
+	NSManagedObjectID* current = [_recentCharts count] > 0 ? [_recentCharts objectAtIndex:0] : nil;
+	NSMutableArray* victims = [NSMutableArray arrayWithArray:[bytesByChart allKeys]];
+	[victims removeObjectsInArray:_recentCharts];
+	for (NSManagedObjectID* chartID in [_recentCharts reverseObjectEnumerator]) {
+		if (![chartID isEqual:current] && [bytesByChart objectForKey:chartID]) {
+			[victims addObject:chartID];
+		}
+	}
+	
+	for (NSManagedObjectID* chartID in victims) {
+		if (total <= maxBytes) {
+			break;
+		}
+		Chart* chart = (Chart*)[context objectRegisteredForID:chartID];
+		for (ChartSeries* series in chart.series) {
+			for (ChartDataset* dataset in series.datasets) {
+				if (![dataset isFault] && ![dataset hasChanges]) {
+					[context refreshObject:dataset mergeChanges:NO];
+				}
+			}
+		}
+		total -= [[bytesByChart objectForKey:chartID] unsignedIntegerValue];
+	}
+#ifdef CHART_MEMORY_LOGGING
+	NSLog(@"Chart data resident after trimming: %lu bytes", (unsigned long)[self residentBytes]);
+#endif
+}
+
+- (void)trimToBudget
+{
+	[self trimToBytes:_maxResidentBytes];
+}
+
+- (void)didReceiveMemoryWarning:(NSNotification*)notification
+{
+	[self trimToBytes:0];
+}
+
+- (void)evictUnviewedCharts
+{
+	assert([NSThread isMainThread]);
+	NSManagedObjectContext* context = [[DataManager manager] rootContext];
+	NSDate* cutoff = [NSDate dateWithTimeIntervalSinceNow:-(NSTimeInterval)_maxUnviewedDays * 24 * 60 * 60];
+	
+	NSMutableArray* favouriteUrns = [NSMutableArray array];
+	for (Place* place in [Favourites favourites].items) {
+		[favouriteUrns addObject:place.urn];
+	}
+	
+	NSFetchRequest* request = [[[NSFetchRequest alloc] init] autorelease];
+	[request setEntity:[NSEntityDescription entityForName:@"Chart" inManagedObjectContext:context]];
+	[request setPredicate:[NSPredicate predicateWithFormat:
+						   @"(viewDate < %@ || (viewDate == nil && loadDate < %@)) && NOT (place.urn in %@)",
+						   cutoff, cutoff, favouriteUrns]];
+	NSError* error = nil;
+	NSArray* charts = [context executeFetchRequest:request error:&error];
+	if (!charts) {
+		NSLog(@"ERROR evictUnviewedCharts: %@", error);
+		return;
+	}
+	if ([charts count] > 0) {
+		NSLog(@"Evicting %lu charts not viewed for %lu days",
+			  (unsigned long)[charts count], (unsigned long)_maxUnviewedDays);
+		for (Chart* chart in charts) {
+			[_recentCharts removeObject:[chart objectID]];
+			[context deleteObject:chart];
+		}
+		[context saveAndLogErrors];
+	}
+}
+
+@end
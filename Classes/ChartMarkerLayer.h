@@ -0,0 +1,55 @@
+//
+//  ChartMarkerLayer.h
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import <QuartzCore/QuartzCore.h>
+#import "CorePlot-CocoaTouch.h"
+
+// Persistent crosshair drawn over the chart while the user touches it.
+// It is a narrow strip layer created once: dragging only moves it and redraws
+// the strip, without reloading plot data or changing the graph's layer tree.
+// Coordinates are in the superlayer, which must be the hosted graph.
+@interface ChartMarkerLayer : CALayer
+{
+	CPColor* _color;
+	CGFloat _symbolSize;
+	CGFloat _lineWidth;
+	NSArray* _pointYPositions;
+}
+
+@property (nonatomic, retain) CPColor* color;
+@property (nonatomic) CGFloat symbolSize;
+@property (nonatomic) CGFloat lineWidth;
+
+// Shows the marker as a vertical line at x spanning [bottom, top], with one
+// symbol per y position. Positions are NSNumber floats in superlayer coordinates.
+- (void)moveToX:(CGFloat)x bottom:(CGFloat)bottom top:(CGFloat)top pointYPositions:(NSArray*)yPositions;
+
+- (void)hide;
+
+@end
@@ -0,0 +1,128 @@
+//
+//  ChartMarkerLayer.m
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import "ChartMarkerLayer.h"
+
+@interface ChartMarkerLayer ()	// private
+
+@property (nonatomic, retain) NSArray* pointYPositions;
+
+@end
+
+
+@implementation ChartMarkerLayer
+
+@synthesize color = _color;
+@synthesize symbolSize = _symbolSize;
+@synthesize lineWidth = _lineWidth;
+@synthesize pointYPositions = _pointYPositions;
+
+- (id)init
+{
+	if ((self = [super init]))
+	{
+		_symbolSize = 6.0f;
+		_lineWidth = 2.5f;
+		self.opaque = NO;
+		self.hidden = YES;
+		self.zPosition = 1000.0f;
+		if ([self respondsToSelector:@selector(setContentsScale:)])
+		{
+			[(id)self setValue:[[UIScreen mainScreen] valueForKey:@"scale"] forKey:@"contentsScale"];
+		}
+	}
+	return self;
+}
+
+
+- (void)dealloc
+{
+	[_color release];
+	[_pointYPositions release];
+	[super dealloc];
+}
+
+
+// No implicit animations: the marker must follow the finger exactly
+- (id <CAAction>)actionForKey:(NSString*)key
+{
+	return nil;
+}
+
+
+- (void)moveToX:(CGFloat)x bottom:(CGFloat)bottom top:(CGFloat)top pointYPositions:(NSArray*)yPositions
+{
+	CGFloat width = MAX(self.symbolSize, self.lineWidth) + 2.0f;
+	CGRect newFrame = CGRectMake(x - width / 2.0f, bottom, width, top - bottom);
+	BOOL sizeChanged = !CGSizeEqualToSize(newFrame.size, self.bounds.size);
+	
+	self.frame = newFrame;
+	self.hidden = NO;
+	
+	//symbols are drawn relative to the strip, so only redraw when they move within it
+	NSMutableArray* relativePositions = [NSMutableArray arrayWithCapacity:[yPositions count]];
+	for (NSNumber* y in yPositions)
+	{
+		[relativePositions addObject:[NSNumber numberWithFloat:[y floatValue] - bottom]];
+	}
+	if (sizeChanged || ![relativePositions isEqualToArray:self.pointYPositions])
+	{
+		self.pointYPositions = relativePositions;
+		[self setNeedsDisplay];
+	}
+}
+
+
+- (void)hide
+{
+	self.hidden = YES;
+}
+
+
+- (void)drawInContext:(CGContextRef)context
+{
+	CGRect bounds = self.bounds;
+	CGFloat centerX = CGRectGetMidX(bounds);
+	CGColorRef cgColor = self.color.cgColor;
+	
+	CGContextSetStrokeColorWithColor(context, cgColor);
+	CGContextSetFillColorWithColor(context, cgColor);
+	CGContextSetLineWidth(context, self.lineWidth);
+	CGContextMoveToPoint(context, centerX, CGRectGetMinY(bounds));
+	CGContextAddLineToPoint(context, centerX, CGRectGetMaxY(bounds));
+	CGContextStrokePath(context);
+	
+	CGFloat size = self.symbolSize;
+	for (NSNumber* y in self.pointYPositions)
+	{
+		CGContextFillEllipseInRect(context, CGRectMake(centerX - size / 2.0f, [y floatValue] - size / 2.0f, size, size));
+	}
+}
+
+@end
@@ -0,0 +1,76 @@
+//
+//  ChartRenderer.h
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import <UIKit/UIKit.h>
+#import "CorePlot-CocoaTouch.h"
+
+@class Chart;
+@class Place;
+@class ChartRenderer;
+
+@protocol ChartRendererDelegate
+
+// Called on the main thread once for every place passed to the renderer that has a chart.
+- (void)chartRenderer:(ChartRenderer*)renderer didRenderImage:(UIImage*)image forPlaceID:(NSManagedObjectID*)placeID;
+
+@end
+
+
+// Draws charts without a CPLayerHostingView, e.g. for list thumbnails, exports and benchmarks.
+// Graphs are built and their plot data loaded from the store on the main thread; only the
+// drawing, which reads nothing but the plots' cached data, runs on the renderer's queue.
+@interface ChartRenderer : NSObject
+{
+	NSOperationQueue* _queue;
+	id <ChartRendererDelegate> _delegate;
+}
+
+@property (nonatomic, assign) id <ChartRendererDelegate> delegate;
+
+// Adds one gap-aware scatter plot for each of the three most recent years of the chart.
+// Plots of the same color share a gradient, so the graph must only be drawn on the main thread.
++ (void)addPlotsForChart:(Chart*)chart toGraph:(CPGraph*)graph;
+
+// Returns a retained graph of the given size showing the chart, with plot data already loaded.
++ (CPXYGraph*)newGraphForChart:(Chart*)chart size:(CGSize)size;
+
+// Draws the graph into a new bitmap; scale is the number of pixels per point.
++ (CGImageRef)newImageOfGraph:(CPGraph*)graph scale:(CGFloat)scale;
+
+// Synchronous rendering on the main thread.
++ (UIImage*)imageForChart:(Chart*)chart size:(CGSize)size;
++ (NSData*)pdfDataForChart:(Chart*)chart size:(CGSize)size;
+
+// Renders in the background and reports each image to the delegate. Places in a batch are
+// drawn one after another; places without a chart are skipped.
+- (void)renderImageForPlace:(Place*)place size:(CGSize)size;
+- (void)renderImagesForPlaces:(NSArray*)places size:(CGSize)size;
+- (void)cancelAllRendering;
+
+@end
@@ -0,0 +1,364 @@
+//
+//  ChartRenderer.m
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import "ChartRenderer.h"
+#import "Chart.h"
+#import "ChartSeries.h"
+#import "Place.h"
+#import "CalendarHelpers.h"
+
+
+@interface ChartRenderOperation : NSOperation
+{
+	CPGraph* _graph;
+	CGFloat _scale;
+	NSManagedObjectID* _placeID;
+	ChartRenderer* _renderer;	// not retained, cancels its operations when released
+	CGImageRef _image;
+}
+
+- (id)initWithGraph:(CPGraph*)graph scale:(CGFloat)scale placeID:(NSManagedObjectID*)placeID renderer:(ChartRenderer*)renderer;
+
+@end
+
+
+@interface ChartRenderer ()	// private
+
++ (void)addPlotsForChart:(Chart*)chart toGraph:(CPGraph*)graph sharedGradients:(BOOL)shared;
++ (CGFloat)screenScale;
+- (void)operationDidRenderImage:(CGImageRef)imageRef forPlaceID:(NSManagedObjectID*)placeID;
+
+@end
+
+
+@implementation ChartRenderer
+
+@synthesize delegate = _delegate;
+
+- (id)init
+{
+	if ((self = [super init]))
+	{
+		_queue = [[NSOperationQueue alloc] init];
+		//one drawing at a time: graphs share colors and line styles that are not thread-safe
+		[_queue setMaxConcurrentOperationCount:1];
+	}
+	return self;
+}
+
+
+- (void)dealloc
+{
+	[_queue cancelAllOperations];
+	[_queue release];
+	[super dealloc];
+}
+
+
++ (void)addPlotsForChart:(Chart*)chart toGraph:(CPGraph*)graph
+{
+	[self addPlotsForChart:chart toGraph:graph sharedGradients:YES];
+}
+
+
++ (void)addPlotsForChart:(Chart*)chart toGraph:(CPGraph*)graph sharedGradients:(BOOL)shared
+{
+	double red = 0.0/255;
+	double green = 186.0/255;
+	double blue = 255.0/255;
+	
+	NSInteger currentYear = [[[NSCalendar gregorian] components:NSYearCalendarUnit fromDate:chart.xEnd] year];
+	NSSortDescriptor *yearDescriptor = [[[NSSortDescriptor alloc] initWithKey:@"year" ascending:NO] autorelease];
+	NSArray* orderedSeries = [[chart.series allObjects] sortedArrayUsingDescriptors:[NSArray arrayWithObject:yearDescriptor]];
+	for (ChartSeries* series in orderedSeries)
+	{
+		float alpha = 0.0f;
+		int year = [series.year intValue];
+		if (year == currentYear)
+		{
+			alpha = 1.0f;
+		}
+		else if (year == currentYear - 1)
+		{
+			alpha = 0.35f;
+		}
+		else if (year == currentYear - 2)
+		{
+			alpha = 0.15f;
+		}
+		else
+		{
+			continue;
+		}
+
+		CPColor* topPlotColor = [CPColor colorWithComponentRed:red green:green blue:blue alpha:alpha-0.15];
+		CPColor* bottomPlotColor = [CPColor colorWithComponentRed:red green:green blue:blue alpha:alpha-0.3];
+		CPColor* lineColor = [CPColor colorWithComponentRed:1.0 green:1.0 blue:1.0 alpha:alpha];
+		CPScatterPlot *plot = [[[CPScatterPlot alloc] initWithFrame:CGRectNull] autorelease];
+		plot.dataLineStyle.lineColor = lineColor;
+		plot.dataLineStyle.lineWidth = 2.0f;
+		plot.decimation = CPScatterPlotDecimationMinMax;
+		//one plot per year: the series inserts gaps between its datasets
+		plot.dataSource = series;
+		
+		CPGradient* plotGradient = [[[CPGradient alloc] init] autorelease];
+		plotGradient = [plotGradient addColorStop:topPlotColor atPosition:0];
+		plotGradient = [plotGradient addColorStop:bottomPlotColor atPosition:1];
+		plotGradient.angle = 270.0f;
+		//on screen, years with the same color share one gradient, which keeps a shading for each
+		//plot's bounding box; graphs drawn off the main thread keep their own, since shadings cache lazily
+		if (shared)
+		{
+			plotGradient = [CPGradient sharedGradient:plotGradient];
+		}
+		CPFill* plotGradientFill = [CPFill fillWithGradient:plotGradient];
+		plot.areaFill = plotGradientFill;
+		plot.areaBaseValue = CPDecimalFromString(@"0.0");
+		
+		[graph addPlot:plot];
+	}
+}
+
+
++ (CPXYGraph*)newGraphForChart:(Chart*)chart size:(CGSize)size
+{
+	assert([NSThread isMainThread]);
+	
+	CPXYGraph* graph = [[CPXYGraph alloc] initWithFrame:CGRectMake(0.0f, 0.0f, size.width, size.height)];
+	graph.paddingLeft = 0.0f;
+	graph.paddingBottom = 0.0f;
+	graph.paddingRight = 0.0f;
+	graph.paddingTop = 0.0f;
+	graph.plotAreaFrame.paddingLeft = 0.0f;
+	graph.plotAreaFrame.paddingBottom = 0.0f;
+	graph.plotAreaFrame.paddingRight = 0.0f;
+	graph.plotAreaFrame.paddingTop = 0.0f;
+	
+	CPGradient *backgroundGradient = [[[CPGradient alloc] init] autorelease];
+	CPColor* topBackgroundColor = [CPColor colorWithComponentRed:9.0/255.0 green:102.0/255.0 blue:180.0/255.0 alpha:1.0];
+	CPColor* bottomBackgroundColor = [CPColor colorWithComponentRed:4.0/255.0 green:77.0/255.0 blue:123.0/255.0 alpha:1.0];
+	backgroundGradient = [backgroundGradient addColorStop:topBackgroundColor atPosition:0.0];
+	backgroundGradient = [backgroundGradient addColorStop:bottomBackgroundColor atPosition:1.0];
+	backgroundGradient.angle = 270.0;
+	//not shared: the graph may be drawn on the renderer's queue
+	graph.plotAreaFrame.fill = [CPFill fillWithGradient:backgroundGradient];
+	
+	CPXYPlotSpace* plotSpace = (CPXYPlotSpace *)graph.defaultPlotSpace;
+	plotSpace.doublePrecisionArithmetic = YES;
+	plotSpace.xRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromInteger(1)
+												   length:CPDecimalFromInteger(366)];
+	plotSpace.yRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromFloat(0.0f)
+												   length:CPDecimalFromFloat(1.1f)];
+	
+	//no axis lines, ticks or labels: text drawing needs UIKit, which is main-thread only before iOS 4
+	CPLineStyle* invisibleLineStyle = [CPLineStyle lineStyle];
+	invisibleLineStyle.lineWidth = 0.0f;
+	CPXYAxisSet* axisSet = (CPXYAxisSet*)graph.axisSet;
+	for (CPXYAxis* axis in [NSArray arrayWithObjects:axisSet.xAxis, axisSet.yAxis, nil])
+	{
+		axis.axisLineStyle = invisibleLineStyle;
+		axis.majorTickLength = 0.0f;
+		axis.minorTicksPerInterval = 0;
+		axis.labelingPolicy = CPAxisLabelingPolicyLocationsProvided;
+	}
+	
+	[self addPlotsForChart:chart toGraph:graph sharedGradients:NO];
+	
+	//read the store now, so that drawing never touches managed objects
+	for (CPPlot* plot in [graph allPlots])
+	{
+		[plot reloadData];
+	}
+	return graph;
+}
+
+
++ (CGImageRef)newImageOfGraph:(CPGraph*)graph scale:(CGFloat)scale
+{
+	CGSize size = graph.bounds.size;
+	size_t width = (size_t)ceil(size.width * scale);
+	size_t height = (size_t)ceil(size.height * scale);
+	if (width == 0 || height == 0) {
+		return NULL;
+	}
+	
+	CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+	CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace, kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+	CGColorSpaceRelease(colorSpace);
+	if (!context) {
+		NSLog(@"Could not create a %zux%zu bitmap context for chart rendering", width, height);
+		return NULL;
+	}
+	CGContextScaleCTM(context, scale, scale);
+	
+	//layout may change layer frames: keep it out of any implicit animation on this thread
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
+	[graph layoutAndRenderInContext:context];
+	[CATransaction commit];
+	
+	CGImageRef image = CGBitmapContextCreateImage(context);
+	CGContextRelease(context);
+	return image;
+}
+
+
++ (UIImage*)imageForChart:(Chart*)chart size:(CGSize)size
+{
+	CPXYGraph* graph = [self newGraphForChart:chart size:size];
+	CGImageRef imageRef = [self newImageOfGraph:graph scale:[self screenScale]];
+	[graph release];
+	if (!imageRef) {
+		return nil;
+	}
+	
+	UIImage* image = nil;
+	if ([UIImage respondsToSelector:@selector(imageWithCGImage:scale:orientation:)]) {
+		image = [UIImage imageWithCGImage:imageRef scale:[self screenScale] orientation:UIImageOrientationUp];
+	} else {
+		image = [UIImage imageWithCGImage:imageRef];
+	}
+	CGImageRelease(imageRef);
+	return image;
+}
+
+
++ (NSData*)pdfDataForChart:(Chart*)chart size:(CGSize)size
+{
+	CPXYGraph* graph = [self newGraphForChart:chart size:size];
+	NSData* pdfData = [graph dataForPDFRepresentationOfLayer];
+	[graph release];
+	return pdfData;
+}
+
+
+- (void)renderImageForPlace:(Place*)place size:(CGSize)size
+{
+	[self renderImagesForPlaces:[NSArray arrayWithObject:place] size:size];
+}
+
+
+- (void)renderImagesForPlaces:(NSArray*)places size:(CGSize)size
+{
+	assert([NSThread isMainThread]);
+	
+	CGFloat scale = [ChartRenderer screenScale];
+	for (Place* place in places)
+	{
+		if (!place.chart) {
+			continue;
+		}
+		CPXYGraph* graph = [ChartRenderer newGraphForChart:place.chart size:size];
+		ChartRenderOperation* operation = [[ChartRenderOperation alloc] initWithGraph:graph
+																				scale:scale
+																			  placeID:[place objectID]
+																			 renderer:self];
+		[_queue addOperation:operation];
+		[operation release];
+		[graph release];
+	}
+}
+
+
+- (void)cancelAllRendering
+{
+	[_queue cancelAllOperations];
+}
+
+
+- (void)operationDidRenderImage:(CGImageRef)imageRef forPlaceID:(NSManagedObjectID*)placeID
+{
+	UIImage* image = nil;
+	CGFloat scale = [ChartRenderer screenScale];
+	if ([UIImage respondsToSelector:@selector(imageWithCGImage:scale:orientation:)]) {
+		image = [UIImage imageWithCGImage:imageRef scale:scale orientation:UIImageOrientationUp];
+	} else {
+		image = [UIImage imageWithCGImage:imageRef];
+	}
+	[self.delegate chartRenderer:self didRenderImage:image forPlaceID:placeID];
+}
+
+
++ (CGFloat)screenScale
+{
+	UIScreen* screen = [UIScreen mainScreen];
+	return [screen respondsToSelector:@selector(scale)] ? [screen scale] : 1.0f;
+}
+
+@end
+
+
+@implementation ChartRenderOperation
+
+- (id)initWithGraph:(CPGraph*)graph scale:(CGFloat)scale placeID:(NSManagedObjectID*)placeID renderer:(ChartRenderer*)renderer
+{
+	if ((self = [super init]))
+	{
+		_graph = [graph retain];
+		_scale = scale;
+		_placeID = [placeID retain];
+		_renderer = renderer;
+	}
+	return self;
+}
+
+
+- (void)dealloc
+{
+	[_graph release];
+	[_placeID release];
+	CGImageRelease(_image);
+	[super dealloc];
+}
+
+
+- (void)main
+{
+	NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+	if (![self isCancelled])
+	{
+		_image = [ChartRenderer newImageOfGraph:_graph scale:_scale];
+		if (_image && ![self isCancelled]) {
+			[self performSelectorOnMainThread:@selector(deliverImage) withObject:nil waitUntilDone:NO];
+		}
+	}
+	[pool release];
+}
+
+
+- (void)deliverImage
+{
+	assert([NSThread isMainThread]);
+	//a released renderer cancels its operations first, on this same thread
+	if (![self isCancelled]) {
+		[_renderer operationDidRenderImage:_image forPlaceID:_placeID];
+	}
+}
+
+@end
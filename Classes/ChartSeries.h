@@ -30,12 +30,15 @@
 //
 
 #import <CoreData/CoreData.h>
+#import "CorePlot-CocoaTouch.h"
 
 @class ChartDataset;
 @class Chart;
 @class ChartValue;
 
-@interface ChartSeries :  NSManagedObject  
+// Plots every dataset of the year as a single scatter plot, with a NaN gap record
+// between consecutive datasets so the line and fill break where data is missing.
+@interface ChartSeries :  NSManagedObject <CPPlotDataSource>
 {
 	NSNumber* _leapYear;
 }
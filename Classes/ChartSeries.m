@@ -33,6 +33,13 @@
 #import "ChartDataset.h"
 #import "ChartValue.h"
 
+@interface ChartSeries ()	// private
+
+- (NSArray*)orderedDatasets;
+
+@end
+
+
 @implementation ChartSeries 
 
 @dynamic year;
@@ -64,4 +71,54 @@
 	return nil;
 }
 
+- (NSArray*)orderedDatasets
+{
+	NSMutableArray* result = [NSMutableArray arrayWithCapacity:[self.datasets count]];
+	for (ChartDataset* set in self.datasets)
+	{
+		if ([set.values count] > 0)
+		{
+			[result addObject:set];
+		}
+	}
+	[result sortUsingDescriptors:[NSArray arrayWithObject:
+		[[[NSSortDescriptor alloc] initWithKey:@"values.@min.dayInYear" ascending:YES] autorelease]]];
+	return result;
+}
+
+
+-(NSUInteger)numberOfRecordsForPlot:(CPPlot *)plot
+{
+	NSUInteger count = 0;
+	for (ChartDataset* set in self.datasets)
+	{
+		if ([set.values count] > 0)
+		{
+			//one gap record before every dataset but the first
+			count += (count > 0 ? 1 : 0) + [set.values count];
+		}
+	}
+	return count;
+}
+
+
+-(NSArray*)numbersForPlot:(CPPlot*)plot field:(NSUInteger)fieldEnum  
+		 recordIndexRange:(NSRange)indexRange
+{
+	NSString* key = (fieldEnum == CPScatterPlotFieldX ? @"dayInYear" : @"percentage");
+	NSNumber* gap = [NSNumber numberWithDouble:NAN];
+	
+	NSMutableArray* result = [NSMutableArray arrayWithCapacity:[self numberOfRecordsForPlot:plot]];
+	for (ChartDataset* set in [self orderedDatasets])
+	{
+		if ([result count] > 0)
+		{
+			[result addObject:gap];
+		}
+		[result addObjectsFromArray:[set.values valueForKey:key]];
+	}
+	NSAssert(NSMaxRange(indexRange) <= [result count], @"ChartSeries: incorrect indexRange requested");
+	return [result subarrayWithRange:indexRange];
+}
+
 @end
@@ -36,6 +36,7 @@
 @class Chart;
 @class ChartValue;
 @class Measurement;
+@class ChartMarkerLayer;
 
 @protocol MarkerLabelDelegate
 
@@ -57,13 +58,13 @@
 @end
 
 
-@interface ChartViewController : UIViewController <CPPlotSpaceDelegate, CPPlotDataSource>
+@interface ChartViewController : UIViewController <CPPlotSpaceDelegate>
 {
 	CPXYGraph* graph;
 	Place* place;
 	Chart* _chart;	// not retained
 	//marker
-	CPScatterPlot* _markerPlot;
+	ChartMarkerLayer* _markerLayer;
 	id <MarkerLabelDelegate> _markerLabelDelegate;
 	id <ChartDelegate> _chartDelegate;
 	int _xCoordinate;
@@ -86,4 +87,10 @@
 
 -(CGPoint)viewCoordinatesForChartPoint:(NSDecimal*)chartPoint;
 
+#ifdef MARKER_DRAG_TIMING
+// Drives a synthetic touch-down, drag and touch-up sequence across the chart
+// and logs the time spent handling each drag event.
+- (void)runMarkerDragTiming;
+#endif
+
 @end
@@ -39,18 +39,25 @@
 #import "Place.h"
 #import "Observation.h"
 #import "CalendarHelpers.h"
+#import "ChartMarkerLayer.h"
+#import "ChartRenderer.h"
+#import "ChartBudget.h"
 
 @interface ChartViewController ()	// private
 
 @property (nonatomic, retain) CPXYGraph* graph;
-@property (nonatomic, retain) CPScatterPlot* markerPlot;
 //marker
+@property (nonatomic, retain) ChartMarkerLayer* markerLayer;
 @property (nonatomic) int xCoordinate;
 @property (nonatomic) float viewXPosition;
 @property (nonatomic, retain) NSMutableArray* yCoordinates;
 
 - (void)updateChart:(Chart*)chart;
 
+- (int)dayForPoint:(CGPoint)point;
+- (void)moveMarkerToPoint:(CGPoint)point;
+- (void)hideMarker;
+
 - (void)createPlotSpace;
 
 @end
@@ -67,7 +74,7 @@ CGFloat const kChartTopYValue = 1.1f;
 CGFloat const kMaxYValue = 4.0f;
 
 @synthesize graph;
-@synthesize markerPlot = _markerPlot;
+@synthesize markerLayer = _markerLayer;
 @synthesize xCoordinate = _xCoordinate;
 @synthesize viewXPosition = _viewXPosition;
 @synthesize yCoordinates = _yCoordinates;
@@ -78,7 +85,7 @@ CGFloat const kMaxYValue = 4.0f;
 	[[NSNotificationCenter defaultCenter] removeObserver:self];
 	[graph release];
 	[place release];
-	[_markerPlot release];
+	[_markerLayer release];
 	[_yCoordinates release];
 	[super dealloc];
 }
@@ -113,7 +120,7 @@ CGFloat const kMaxYValue = 4.0f;
 	// Release any retained subviews of the main view.
 	// e.g. self.myOutlet = nil;
 	self.graph = nil;
-	self.markerPlot = nil;
+	self.markerLayer = nil;
 	self.yCoordinates = nil;
 }
 
@@ -142,58 +149,10 @@ CGFloat const kMaxYValue = 4.0f;
 		[self.graph removePlot:plot];
 	}
 	//discard potential marker
-	self.markerPlot = nil;
-	[self.markerLabelDelegate hideLabels];
+	[self hideMarker];
 	
-	double red = 0.0/255;
-	double green = 186.0/255;
-	double blue = 255.0/255;
-	
-	NSInteger currentYear = [[[NSCalendar gregorian] components:NSYearCalendarUnit fromDate:chart.xEnd] year];
-	NSSortDescriptor *yearDescriptor = [[[NSSortDescriptor alloc] initWithKey:@"year" ascending:NO] autorelease];
-	NSArray* orderedSeries = [[chart.series allObjects] sortedArrayUsingDescriptors:[NSArray arrayWithObject:yearDescriptor]];
-	for (ChartSeries* series in orderedSeries)
-	{
-		float alpha = 0.0f;
-		int year = [series.year intValue];
-		if (year == currentYear)
-		{
-			alpha = 1.0f;
-		}
-		else if (year == currentYear - 1)
-		{
-			alpha = 0.35f;
-		}
-		else if (year == currentYear - 2)
-		{
-			alpha = 0.15f;
-		}
-		else
-		{
-			continue;
-		}
-
-		CPColor* topPlotColor = [CPColor colorWithComponentRed:red green:green blue:blue alpha:alpha-0.15];
-		CPColor* bottomPlotColor = [CPColor colorWithComponentRed:red green:green blue:blue alpha:alpha-0.3];
-		CPColor* lineColor = [CPColor colorWithComponentRed:1.0 green:1.0 blue:1.0 alpha:alpha];
-		for (ChartDataset* dataset in series.datasets)
-		{
-			CPScatterPlot *plot = [[[CPScatterPlot alloc] initWithFrame:CGRectNull] autorelease];
-			plot.dataLineStyle.lineColor = lineColor;
-			plot.dataLineStyle.lineWidth = 2.0f;
-			plot.dataSource = dataset;
-			
-			CPGradient* plotGradient = [[[CPGradient alloc] init] autorelease];
-			plotGradient = [plotGradient addColorStop:topPlotColor atPosition:0];
-			plotGradient = [plotGradient addColorStop:bottomPlotColor atPosition:1];
-			plotGradient.angle = 270.0f;
-			CPFill* plotGradientFill = [CPFill fillWithGradient:plotGradient];
-			plot.areaFill = plotGradientFill;
-			plot.areaBaseValue = CPDecimalFromString(@"0.0");
-			
-			[self.graph addPlot:plot];
-		}
-	}
+	[[ChartBudget sharedBudget] chartWillBeShown:chart];
+	[ChartRenderer addPlotsForChart:chart toGraph:self.graph];
 	[self.chartDelegate chartUpdated];
 }
 
@@ -201,6 +160,8 @@ CGFloat const kMaxYValue = 4.0f;
 - (void)createPlotSpace
 {
 	CPXYPlotSpace* plotSpace = (CPXYPlotSpace *)self.graph.defaultPlotSpace;
+	//days and percentages need no more than double precision
+	plotSpace.doublePrecisionArithmetic = YES;
 	plotSpace.xRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromInteger(1)
 												   length:CPDecimalFromInteger(366)];
 	plotSpace.yRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromFloat(0.0f)
@@ -244,6 +205,11 @@ CGFloat const kMaxYValue = 4.0f;
 	y.axisLineStyle = invisibleLineStyle;
 	
 	y.visibleRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromInteger(0) length:CPDecimalFromInteger(1)];
+	
+	//background and grid only change with bounds, styles or ranges: keep them as bitmaps
+	self.graph.plotAreaFrame.cachesRenderedContents = YES;
+	self.graph.plotAreaFrame.plotArea.majorGridLineGroup.cachesRenderedContents = YES;
+	self.graph.plotAreaFrame.plotArea.minorGridLineGroup.cachesRenderedContents = YES;
 }
 
 
@@ -274,6 +240,9 @@ CGFloat const kMaxYValue = 4.0f;
 	[super viewWillAppear:animated];
 	//NSLog(@"viewWillAppear, for place: %@", self.place);
 	[self updateChart:place.chart];
+#ifdef MARKER_DRAG_TIMING
+	[self performSelector:@selector(runMarkerDragTiming) withObject:nil afterDelay:1.0];
+#endif
 }
 
 
@@ -308,9 +277,14 @@ CGFloat const kMaxYValue = 4.0f;
 	backgroundGradient = [backgroundGradient addColorStop:topBackgroundColor atPosition:0.0];
 	backgroundGradient = [backgroundGradient addColorStop:bottomBackgroundColor atPosition:1.0];
 	backgroundGradient.angle = 270.0;
-	self.graph.plotAreaFrame.fill = [CPFill fillWithGradient:backgroundGradient];
+	self.graph.plotAreaFrame.fill = [CPFill fillWithGradient:[CPGradient sharedGradient:backgroundGradient]];
 	//NSLog(@"graph view created");
 	[self createPlotSpace];
+	
+	//created once, only moved while the user drags across the chart
+	self.markerLayer = [[[ChartMarkerLayer alloc] init] autorelease];
+	self.markerLayer.color = [CPColor colorWithComponentRed:0.9 green:0.80 blue:0.05 alpha:1.0];
+	[self.graph addSublayer:self.markerLayer];
 }
 
 
@@ -354,8 +328,7 @@ CGFloat const kMaxYValue = 4.0f;
 	NSString* volumeUnit = place.obsCurrent.capacity.unit ?: @"ML";
 	
 	NSMutableArray* observations = [NSMutableArray arrayWithCapacity:3];
-	self.yCoordinates = [NSMutableArray arrayWithCapacity:3+2];
-	[self.yCoordinates addObject:[NSNumber numberWithInt:-10]];
+	self.yCoordinates = [NSMutableArray arrayWithCapacity:3];
 	for (NSInteger yearIndex = currentYear; yearIndex > currentYear - 3; yearIndex--)
 	{
 		NSPredicate* predicate = [NSPredicate predicateWithFormat:@"year == %@", [NSNumber numberWithInt:yearIndex]];
@@ -383,7 +356,6 @@ CGFloat const kMaxYValue = 4.0f;
 														  percentageVolume:percentageVolume
 																	volume:volume]];
 	}
-	[self.yCoordinates addObject:[NSNumber numberWithInt:10]];
 	[self.markerLabelDelegate showLabelsForChartObservations:observations awayFrom:self.viewXPosition];
 }
 
@@ -398,140 +370,124 @@ CGFloat const kMaxYValue = 4.0f;
 	return pointInView;
 }	
 
-#pragma mark CPPlotSpaceDelegate protocol
-
--(BOOL)plotSpace:(CPPlotSpace *)space shouldHandlePointingDeviceDownEvent:(id)event atPoint:(CGPoint)point
+- (int)dayForPoint:(CGPoint)point
 {
-	/*NSLog(@"shouldHandlePointingDeviceDownEvent\nevent=%@\npoint=(%f, %f)", event, point.x, point.y);
-	NSLog(@"bounds (%f,%f) (%f,%f)", self.view.bounds.origin.x, self.view.bounds.origin.y, self.view.bounds.size.width, self.view.bounds.size.height);
-	NSLog(@"frame (%f,%f) (%f,%f)", self.view.frame.origin.x, self.view.frame.origin.y, self.view.frame.size.width, self.view.frame.size.height);*/
 	//WARNING coreplot plotAreaFrame translation is incorrect if paddings are used
-	CGPoint pointInPlotArea = [self.graph convertPoint:point toLayer:self.graph.plotAreaFrame];	
+	CGPoint pointInPlotArea = [self.graph convertPoint:point toLayer:self.graph.plotAreaFrame];
 	
 	NSDecimal newPoint[2];
 	[self.graph.defaultPlotSpace plotPoint:newPoint forPlotAreaViewPoint:pointInPlotArea];
 	NSDecimalRound(&newPoint[0], &newPoint[0], 0, NSRoundPlain);
 	int x = [[NSDecimalNumber decimalNumberWithDecimal:newPoint[0]] intValue];
 	
-	//NSLog(@"x=%d", x);
 	if (x<1) {x = 1;}
 	else if (x>366) {x = 366;}
-	/*NSLog(@"coordinates point: (%f, %f) pointInPlotArea: (%f, %f)", 
-		  point.x, point.y, 
-		  pointInPlotArea.x, pointInPlotArea.y);
-	NSLog(@"touch down at: %f, %f (point: %f, %f)", 
-		  [[NSDecimalNumber decimalNumberWithDecimal:newPoint[0]] doubleValue], 
-		  [[NSDecimalNumber decimalNumberWithDecimal:newPoint[1]] doubleValue],
-		  point.x, 
-		  point.y);*/
-	
-	if (self.markerPlot)
-	{
-		[self.graph removePlot:self.markerPlot];
+	return x;
+}
+
+
+- (void)moveMarkerToPoint:(CGPoint)point
+{
+	int x = [self dayForPoint:point];
+	if (x == self.xCoordinate && !self.markerLayer.hidden) {
+		return;
 	}
-	self.markerPlot = [[[CPScatterPlot alloc] 
-						initWithFrame:CGRectNull] autorelease];
 	self.xCoordinate = x;
 	self.viewXPosition = point.x;
-	
-	CPColor* yellow = [CPColor colorWithComponentRed:0.9 green:0.80 blue:0.05 alpha:1.0];
 	[self updateMarkerValues];
 	
-	CPLineStyle *symbolLineStyle = [CPLineStyle lineStyle];
-	symbolLineStyle.lineColor = yellow;
-	CPPlotSymbol *plotSymbol = [CPPlotSymbol ellipsePlotSymbol];
-	plotSymbol.fill = [CPFill fillWithColor:yellow];
-	plotSymbol.lineStyle = symbolLineStyle;
-	plotSymbol.size = CGSizeMake(6.0, 6.0);
-	_markerPlot.plotSymbol = plotSymbol;
-	
-	_markerPlot.dataLineStyle.lineColor = yellow;
-	_markerPlot.dataLineStyle.lineWidth = 2.5f;
-	_markerPlot.dataSource = self;
+	CPPlotArea* plotArea = self.graph.plotAreaFrame.plotArea;
+	CPPlotSpace* plotSpace = self.graph.defaultPlotSpace;
+	NSMutableArray* yPositions = [NSMutableArray arrayWithCapacity:[self.yCoordinates count]];
+	CGPoint viewPoint = CGPointZero;
+	for (NSNumber* y in self.yCoordinates) {
+		double plotPoint[2];
+		plotPoint[CPCoordinateX] = x;
+		plotPoint[CPCoordinateY] = [y doubleValue];
+		viewPoint = [self.graph convertPoint:[plotSpace plotAreaViewPointForDoublePrecisionPlotPoint:plotPoint] fromLayer:plotArea];
+		[yPositions addObject:[NSNumber numberWithFloat:viewPoint.y]];
+	}
+	double plotPoint[2];
+	plotPoint[CPCoordinateX] = x;
+	plotPoint[CPCoordinateY] = 0.0;
+	viewPoint = [self.graph convertPoint:[plotSpace plotAreaViewPointForDoublePrecisionPlotPoint:plotPoint] fromLayer:plotArea];
 	
-	[self.graph addPlot:_markerPlot];
-	return YES;
+	CGRect plotAreaRect = [self.graph convertRect:plotArea.bounds fromLayer:plotArea];
+	[self.markerLayer moveToX:viewPoint.x
+					   bottom:CGRectGetMinY(plotAreaRect)
+						  top:CGRectGetMaxY(plotAreaRect)
+			  pointYPositions:yPositions];
 }
 
--(BOOL)plotSpace:(CPPlotSpace *)space shouldHandlePointingDeviceDraggedEvent:(id)event atPoint:(CGPoint)point
+
+- (void)hideMarker
 {
-	/*NSLog(@"shouldHandlePointingDeviceDraggedEvent\nevent=%@\npoint=(%f, %f)", event, point.x, point.y);*/
-	if (self.markerPlot)
-	{
-		CGPoint pointInPlotArea = [self.graph convertPoint:point toLayer:self.graph.plotAreaFrame];
-		NSDecimal newPoint[2];
-		[self.graph.defaultPlotSpace plotPoint:newPoint forPlotAreaViewPoint:pointInPlotArea];
-		/*NSLog(@"touch dragged to: %f, %f", 
-			  [[NSDecimalNumber decimalNumberWithDecimal:newPoint[0]] doubleValue], 
-			  [[NSDecimalNumber decimalNumberWithDecimal:newPoint[1]] doubleValue]);*/
-		NSDecimalRound(&newPoint[0], &newPoint[0], 0, NSRoundPlain);
-		int x = [[NSDecimalNumber decimalNumberWithDecimal:newPoint[0]] intValue];
-		
-		//NSLog(@"pos=%f val=%f  x=%d", point.x, [[NSDecimalNumber decimalNumberWithDecimal:newPoint[0]] doubleValue], x);
-		if (x<1) {x = 1;}
-		else if (x>366) {x = 366;}
-		
-		if (self.xCoordinate != x) {
-			self.xCoordinate = x;
-			self.viewXPosition = point.x;
-			[self updateMarkerValues];
-			[self.markerPlot reloadData];
-		}
-	}
-	return YES;
+	[self.markerLayer hide];
+	[self.markerLabelDelegate hideLabels];
 }
 
+#pragma mark CPPlotSpaceDelegate protocol
 
--(BOOL)plotSpace:(CPPlotSpace *)space shouldHandlePointingDeviceCancelledEvent:(id)event
+-(BOOL)plotSpace:(CPPlotSpace *)space shouldHandlePointingDeviceDownEvent:(id)event atPoint:(CGPoint)point
 {
-	/*NSLog(@"shouldHandlePointingDeviceCancelledEvent\nevent=%@", event);
-	NSLog(@"touch cancelled, plot was drawn: %@", self.markerPlot ? @"YES" : @"NO");*/
-	if (self.markerPlot)
-	{
-		[self.graph removePlot:self.markerPlot];
-		self.markerPlot = nil;
-		[self.markerLabelDelegate hideLabels];
-	}
+	[self hideMarker];
+	[self moveMarkerToPoint:point];
 	return YES;
 }
 
-
--(BOOL)plotSpace:(CPPlotSpace *)space shouldHandlePointingDeviceUpEvent:(id)event atPoint:(CGPoint)point
+-(BOOL)plotSpace:(CPPlotSpace *)space shouldHandlePointingDeviceDraggedEvent:(id)event atPoint:(CGPoint)point
 {
-	/*NSLog(@"shouldHandlePointingDeviceUpvent\nevent=%@\npoint=(%f, %f)", event, point.x, point.y);*/
-	if (self.markerPlot)
+	if (!self.markerLayer.hidden)
 	{
-		[self.graph removePlot:self.markerPlot];
-		self.markerPlot = nil;
-		[self.markerLabelDelegate hideLabels];
+		[self moveMarkerToPoint:point];
 	}
 	return YES;
 }
 
 
-#pragma mark CPPlotDataSource protocol
+-(BOOL)plotSpace:(CPPlotSpace *)space shouldHandlePointingDeviceCancelledEvent:(id)event
+{
+	[self hideMarker];
+	return YES;
+}
 
 
--(NSUInteger)numberOfRecordsForPlot:(CPPlot *)plot
+-(BOOL)plotSpace:(CPPlotSpace *)space shouldHandlePointingDeviceUpEvent:(id)event atPoint:(CGPoint)point
 {
-	return [self.yCoordinates count];
+	[self hideMarker];
+	return YES;
 }
 
+#ifdef MARKER_DRAG_TIMING
 
--(NSArray*)numbersForPlot:(CPPlot*)plot field:(NSUInteger)fieldEnum  
-		 recordIndexRange:(NSRange)indexRange
+- (void)runMarkerDragTiming
 {
-	if (fieldEnum == CPScatterPlotFieldX)
-	{
-		NSMutableArray* result = [NSMutableArray arrayWithCapacity:[self.yCoordinates count]];
-		for (int i=0; i<[self.yCoordinates count]; i++) {
-			[result addObject:[NSNumber numberWithInt:_xCoordinate]];
-		}
-		return result;
-	} else {
-		//CPScatterPlotFieldY
-		return self.yCoordinates;
+	assert([NSThread isMainThread]);
+	//one event per day across the whole year
+	NSUInteger steps = 366;
+	CGRect plotAreaRect = [self.graph convertRect:self.graph.plotAreaFrame.plotArea.bounds
+										fromLayer:self.graph.plotAreaFrame.plotArea];
+	CGFloat y = CGRectGetMidY(plotAreaRect);
+	CPPlotSpace* space = self.graph.defaultPlotSpace;
+	
+	[self plotSpace:space shouldHandlePointingDeviceDownEvent:nil atPoint:CGPointMake(CGRectGetMinX(plotAreaRect), y)];
+	NSTimeInterval total = 0.0;
+	NSTimeInterval worst = 0.0;
+	for (NSUInteger i = 1; i <= steps; i++) {
+		CGFloat x = CGRectGetMinX(plotAreaRect) + CGRectGetWidth(plotAreaRect) * i / steps;
+		CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+		[self plotSpace:space shouldHandlePointingDeviceDraggedEvent:nil atPoint:CGPointMake(x, y)];
+		[self.markerLayer displayIfNeeded];
+		NSTimeInterval elapsed = CFAbsoluteTimeGetCurrent() - start;
+		total += elapsed;
+		worst = MAX(worst, elapsed);
 	}
+	[self plotSpace:space shouldHandlePointingDeviceUpEvent:nil atPoint:CGPointZero];
+	
+	NSLog(@"Marker drag timing: %u steps, mean %.3f ms, worst %.3f ms (%@ 60 fps budget)",
+		  (unsigned)steps, total / steps * 1000.0, worst * 1000.0, worst < 1.0 / 60.0 ? @"within" : @"over");
 }
 
+#endif
+
 @end
@@ -0,0 +1,65 @@
+//
+//  DailyObservation.h
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import <CoreData/CoreData.h>
+
+@class Place;
+@class Observation;
+
+// One day of a place's observation history. Every observation seen by PlaceParser, current or
+// previous, is recorded, so history accumulates locally beyond the five observations of Place.
+//
+// Rows are keyed by place and dayIndex, the number of whole UTC days since 1970, and hold the
+// measurements as plain doubles: volumes in megalitres, percentages in percent. A later import
+// of the same day replaces that day's values; days are never removed except with their place.
+@interface DailyObservation : NSManagedObject
+{
+}
+
+@property (nonatomic, retain) Place* place;
+@property (nonatomic, retain) NSNumber* dayIndex;
+@property (nonatomic, retain) NSNumber* capacity;
+@property (nonatomic, retain) NSNumber* percentageVolume;
+@property (nonatomic, retain) NSNumber* volume;
+
++ (NSEntityDescription*)entity;
+
++ (NSInteger)dayIndexForDate:(NSDate*)date;
++ (NSDate*)dateForDayIndex:(NSInteger)dayIndex;
+
+// Records the observation for its observationDate. Does nothing if it has no date.
++ (void)recordObservation:(Observation*)observation forPlace:(Place*)place;
+
+// The most recent recorded day on or before dayIndex, or nil.
++ (DailyObservation*)observationForPlace:(Place*)place onOrBeforeDayIndex:(NSInteger)dayIndex;
+
+// The recorded days in [firstDayIndex, lastDayIndex], oldest first.
++ (NSArray*)observationsForPlace:(Place*)place fromDayIndex:(NSInteger)firstDayIndex toDayIndex:(NSInteger)lastDayIndex;
+
+@end
@@ -0,0 +1,133 @@
+//
+//  DailyObservation.m
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import "DailyObservation.h"
+#import "Place.h"
+#import "Observation.h"
+#import "Measurement.h"
+#import "DataManager.h"
+
+
+static const NSTimeInterval kSecondsPerDay = 24 * 60 * 60;
+
+
+@implementation DailyObservation
+
+@dynamic place;
+@dynamic dayIndex;
+@dynamic capacity;
+@dynamic percentageVolume;
+@dynamic volume;
+
++ (NSEntityDescription *)entity
+{
+	static NSEntityDescription* entity = nil;
+	
+	if (entity == nil) {
+		NSManagedObjectModel* model = [[DataManager manager] managedObjectModel];
+		entity = [[model entitiesByName] objectForKey:@"DailyObservation"];
+		[entity retain];
+	}
+	return entity;
+}
+
++ (NSInteger)dayIndexForDate:(NSDate*)date
+{
+	return (NSInteger)floor([date timeIntervalSince1970] / kSecondsPerDay);
+}
+
++ (NSDate*)dateForDayIndex:(NSInteger)dayIndex
+{
+	return [NSDate dateWithTimeIntervalSince1970:dayIndex * kSecondsPerDay];
+}
+
++ (void)recordObservation:(Observation*)observation forPlace:(Place*)place
+{
+	if (!observation.observationDate || !place) {
+		return;
+	}
+	NSNumber* dayIndex = [NSNumber numberWithInteger:[self dayIndexForDate:observation.observationDate]];
+	NSManagedObjectContext* context = [place managedObjectContext];
+	
+	NSFetchRequest* request = [[[NSFetchRequest alloc] init] autorelease];
+	[request setEntity:[self entity]];
+	[request setPredicate:[NSPredicate predicateWithFormat:@"place == %@ && dayIndex == %@", place, dayIndex]];
+	[request setFetchLimit:1];
+	NSError* error = nil;
+	NSArray* results = [context executeFetchRequest:request error:&error];
+	if (!results) {
+		NSLog(@"ERROR recordObservation:forPlace: %@", error);
+		return;
+	}
+	
+	DailyObservation* day = [results lastObject];
+	if (!day) {
+		day = [[[DailyObservation alloc] initWithEntity:[self entity] insertIntoManagedObjectContext:context] autorelease];
+		day.place = place;
+		day.dayIndex = dayIndex;
+	}
+	day.capacity = observation.capacity ? [NSNumber numberWithDouble:observation.capacity.value] : nil;
+	day.percentageVolume = observation.percentageVolume ? [NSNumber numberWithDouble:observation.percentageVolume.value] : nil;
+	day.volume = observation.volume ? [NSNumber numberWithDouble:observation.volume.value] : nil;
+}
+
++ (DailyObservation*)observationForPlace:(Place*)place onOrBeforeDayIndex:(NSInteger)dayIndex
+{
+	NSFetchRequest* request = [[[NSFetchRequest alloc] init] autorelease];
+	[request setEntity:[self entity]];
+	[request setPredicate:[NSPredicate predicateWithFormat:@"place == %@ && dayIndex <= %@",
+						   place, [NSNumber numberWithInteger:dayIndex]]];
+	[request setSortDescriptors:[NSArray arrayWithObject:
+								 [[[NSSortDescriptor alloc] initWithKey:@"dayIndex" ascending:NO] autorelease]]];
+	[request setFetchLimit:1];
+	NSError* error = nil;
+	NSArray* results = [[place managedObjectContext] executeFetchRequest:request error:&error];
+	if (!results) {
+		NSLog(@"ERROR observationForPlace:onOrBeforeDayIndex: %@", error);
+	}
+	return [results lastObject];
+}
+
++ (NSArray*)observationsForPlace:(Place*)place fromDayIndex:(NSInteger)firstDayIndex toDayIndex:(NSInteger)lastDayIndex
+{
+	NSFetchRequest* request = [[[NSFetchRequest alloc] init] autorelease];
+	[request setEntity:[self entity]];
+	[request setPredicate:[NSPredicate predicateWithFormat:@"place == %@ && dayIndex >= %@ && dayIndex <= %@",
+						   place, [NSNumber numberWithInteger:firstDayIndex], [NSNumber numberWithInteger:lastDayIndex]]];
+	[request setSortDescriptors:[NSArray arrayWithObject:
+								 [[[NSSortDescriptor alloc] initWithKey:@"dayIndex" ascending:YES] autorelease]]];
+	NSError* error = nil;
+	NSArray* results = [[place managedObjectContext] executeFetchRequest:request error:&error];
+	if (!results) {
+		NSLog(@"ERROR observationsForPlace:fromDayIndex:toDayIndex: %@", error);
+	}
+	return results;
+}
+
+@end
@@ -115,10 +115,12 @@
 	// and NSManagedObjectModel can all be used on multiple threads due to the NSManagedObjectContext
 	// locking them properly, the NSManagedObjectContext itself is not thread safe.
 
-	// That's why we create the context here in the thread, not in init:
+	// That's why we create the context here in the thread, not in init.
+	// It uses its own coordinator, so the main thread's fetches do not wait for
+	// this thread's saves to release the coordinator lock:
 			
 	self.context = [[[NSManagedObjectContext alloc] init] autorelease];
-	[self.context setPersistentStoreCoordinator:[[DataManager manager] persistentStoreCoordinator]];
+	[self.context setPersistentStoreCoordinator:[[DataManager manager] loaderStoreCoordinator]];
 	
 	NSURL* baseURL = [NSURL URLWithString:[DataManager baseUrl]];
 	NSURL* url = [NSURL URLWithString:[self resourcePath] relativeToURL:baseURL];
@@ -205,6 +207,8 @@
 {
 	// FIXME Report the error
 	NSLog(@"Failed to load: %@", [error userInfo]);
+	// What was parsed is still saved, so let the parser finish it, e.g. link new children
+	[self.parser parseEnd];
 	[self endCurrentRequest];
 }
 
@@ -50,6 +50,11 @@
 	DataLoader* loaderInProgress;
 	Reachability* reachability;
 	BOOL networkAlertHasBeenShown;
+	BOOL storeBackfillInProgress;
+#ifdef REQUEST_COUNT_LOGGING
+	NSUInteger roundTrips;
+	NSUInteger placeRequestsLoaded;
+#endif
 	
 	// A queue of id <DataRequestProtocol>. Each is loaded when it reaches index 0.
 	NSMutableArray* queue;
@@ -57,6 +62,13 @@
 	NSManagedObjectContext* rootContext;
 	NSManagedObjectModel *managedObjectModel;
 	NSPersistentStoreCoordinator *persistentStoreCoordinator;
+	NSPersistentStoreCoordinator *loaderStoreCoordinator;
+#ifdef STORE_LOCK_TIMING
+	NSTimer* lockTimingTimer;
+	NSUInteger lockTimingSamples;
+	CFAbsoluteTime lockTimingTotalFetch;
+	CFAbsoluteTime lockTimingMaxFetch;
+#endif
 }
 
 // Get the singleton.
@@ -119,4 +131,9 @@
 - (NSManagedObjectModel*)managedObjectModel;
 - (NSPersistentStoreCoordinator*)persistentStoreCoordinator;
 
+// A second coordinator on the same store, for contexts on loader threads, so that their
+// fetches and saves do not lock out the rootContext. Created on the main thread when the
+// first request starts loading.
+- (NSPersistentStoreCoordinator*)loaderStoreCoordinator;
+
 @end
@@ -37,12 +37,20 @@
 #import "ChartRequest.h"
 #import "Reachability.h"
 #import "DataLoader.h"
+#import "Observation.h"
+#import "PlaceLink.h"
+#import "PlaceBatchRequest.h"
 
 #ifdef CHARTS_INTEGRATION_TEST
 #import "ChartParser.h"
 #import "NSManagedObjectContext+Helpers.h"
 #endif
 
+#ifdef MOBILEDATA_BATCH_INTEGRATION_TEST
+#import "PlaceParser.h"
+#import "NSManagedObjectContext+Helpers.h"
+#endif
+
 // Production: water.bom.gov.au
 // Test:       cdcvt-awwaapp02.bom.gov.au:8080
 NSString* const kHostName = @"water.bom.gov.au";
@@ -51,6 +59,26 @@ NSString* const kBaseURL = @"http://water.bom.gov.au/waterstorage/";
 // flag for model fix stored in store to address corrupted data problem
 NSString* const kCustomMetadataModelFixedChartDeleteRule = @"ChartDeletionRuleInModelFixed";
 
+// flag for stores whose archived observation measurements have been converted to plain attributes
+NSString* const kCustomMetadataMeasurementsCompacted = @"MeasurementsCompacted";
+
+// flag for stores whose PlaceLink closure table has been built from the children relationships
+NSString* const kCustomMetadataPlaceLinksBuilt = @"PlaceLinksBuilt";
+
+// flag for stores whose places have had their sort attributes filled in
+NSString* const kCustomMetadataSortAttributesSet = @"SortAttributesSet";
+
+// Places loaded per request. Batches need the batched mobiledata resource on the server.
+#ifdef MOBILEDATA_BATCH
+static const NSUInteger kMaxPlacesPerRequest = 8;
+#else
+static const NSUInteger kMaxPlacesPerRequest = 1;
+#endif
+
+// Bounds on the memory mapped part of the store, see storePragmas
+static const unsigned long long kMinStoreMapBytes = 4 * 1024 * 1024;
+static const unsigned long long kMaxStoreMapBytes = 32 * 1024 * 1024;
+
 @interface DataManager ()	// private
 
 @property (nonatomic, retain) id <DataRequestProtocol> requestInProgress;
@@ -61,10 +89,21 @@ NSString* const kCustomMetadataModelFixedChartDeleteRule = @"ChartDeletionRuleIn
 - (void)checkQueue;
 - (void)startLoadingRequest:(id <DataRequestProtocol>)request;
 - (void)enqueueRequest:(id <DataRequestProtocol>)request;
+- (id <DataRequestProtocol>)batchRequestStartingWith:(id <DataRequestProtocol>)request;
 - (void)showNetworkAlert;
 - (NSString*)storePath;
 - (NSURL*)storeURL;
+- (NSDictionary*)storePragmas;
+- (void)removeStoreFiles;
 - (void)installDefaultStore;
+- (void)startStoreBackfills;
+- (void)runStoreBackfills:(NSArray*)flags;
+- (void)didFinishStoreBackfills:(NSArray*)flags;
+#ifdef STORE_LOCK_TIMING
+- (void)startLockTiming;
+- (void)sampleLockTiming:(NSTimer*)timer;
+- (void)stopLockTiming;
+#endif
 
 - (NSString *)applicationDocumentsDirectory;
 
@@ -188,11 +227,36 @@ static const NSTimeInterval expireSeconds = 6 * 60 * 60;	// 6hr
 {
 #ifndef CHARTS_INTEGRATION_TEST
 	assert([NSThread isMainThread]);
+#ifdef MOBILEDATA_BATCH_INTEGRATION_TEST
+	// The fixture holds a batched response for Melbourne and Victoria, each with one child
+	NSLog(@"loading static batched mobiledata file");
+	NSBundle* bundle = [NSBundle bundleForClass:[self class]];
+	NSString* inputPath = [bundle pathForResource:@"integration_test_mobiledata_batch" ofType:@"xml"];
+	NSData* data = [NSData dataWithContentsOfFile:inputPath];
+	PlaceParser* parser = [[[PlaceParser alloc] initWithPlace:nil context:self.rootContext] autorelease];
+	[parser parseData:data];
+	[parser parseEnd];
+	assert([parser.requestedPlaces count] == 2);
+	for (Place* requested in parser.requestedPlaces) {
+		assert([requested.children count] > 0);
+		assert(requested.obsCurrent != nil);
+	}
+	// Each section's children belong to the place named by its own <requestIdentifier>
+	Place* victoria = [Place placeWithUrn:@"urn:bom.gov.au:awris:common:codelist:region.state:victoria" context:self.rootContext];
+	Place* melbourne = [Place placeWithUrn:@"urn:bom.gov.au:awris:common:codelist:region.city:melbourne" context:self.rootContext];
+	Place* thomson = [Place placeWithUrn:@"urn:bom.gov.au:awris:common:codelist:feature:thomson" context:self.rootContext];
+	assert([victoria.children containsObject:melbourne]);
+	assert([melbourne.children containsObject:thomson]);
+	assert(![melbourne.children containsObject:melbourne]);
+	[self.rootContext saveAndLogErrors];
+	NSLog(@"static batched mobiledata file loaded and saved in context");
+#else
 	id <DataRequestProtocol> request = [PlaceRequest placeRequestForPlace:place entire:entire force:force];
 	if (![request isSatisfied]) {
 		[self enqueueRequest:request];
 	}
 #endif
+#endif
 }
 
 - (void)loadChartForPlace:(Place*)place force:(BOOL)force
@@ -242,14 +306,19 @@ static const NSTimeInterval expireSeconds = 6 * 60 * 60;	// 6hr
 		// Already busy
 		return;
 	}
+	if (storeBackfillInProgress) {
+		// Loaders could save places the backfill is changing; resumed by didFinishStoreBackfills:
+		return;
+	}
 	while (!self.requestInProgress && [queue count] > 0) {
-		id <DataRequestProtocol> request = [queue objectAtIndex:0];
+		id <DataRequestProtocol> request = [[[queue objectAtIndex:0] retain] autorelease];
+		[queue removeObjectAtIndex:0];
 		if (![request isSatisfied]) {
+			request = [self batchRequestStartingWith:request];
 			self.requestInProgress = request;
 			NSLog(@"Loading %@", request);
 			[self startLoadingRequest:request];
 		}
-		[queue removeObjectAtIndex:0];
 	}
 	if (!self.requestInProgress) {
 		NSLog(@"Queue empty.");
@@ -257,6 +326,31 @@ static const NSTimeInterval expireSeconds = 6 * 60 * 60;	// 6hr
 	[UIApplication sharedApplication].networkActivityIndicatorVisible = self.requestInProgress != nil;
 }
 
+// Takes further unsatisfied PlaceRequests from the queue to load along with request, if it is
+// a PlaceRequest, keeping the rest of the queue in order.
+- (id <DataRequestProtocol>)batchRequestStartingWith:(id <DataRequestProtocol>)request
+{
+	if (kMaxPlacesPerRequest <= 1 || ![(NSObject*)request isMemberOfClass:[PlaceRequest class]]) {
+		return request;
+	}
+	NSMutableArray* batch = [NSMutableArray arrayWithObject:request];
+	for (NSUInteger i = 0; i < [queue count] && [batch count] < kMaxPlacesPerRequest; ) {
+		id <DataRequestProtocol> other = [queue objectAtIndex:i];
+		if ([(NSObject*)other isMemberOfClass:[PlaceRequest class]]
+			&& ![[batch valueForKey:@"place"] containsObject:[(PlaceRequest*)other place]]
+			&& ![other isSatisfied]) {
+			[batch addObject:other];
+			[queue removeObjectAtIndex:i];
+		} else {
+			i++;
+		}
+	}
+	if ([batch count] == 1) {
+		return request;
+	}
+	return [PlaceBatchRequest batchRequestWithRequests:batch];
+}
+
 - (void)startLoadingRequest:(id <DataRequestProtocol>)request
 {
 	assert(loaderInProgress == nil);
@@ -264,6 +358,11 @@ static const NSTimeInterval expireSeconds = 6 * 60 * 60;	// 6hr
 	DataLoader* loader = [request makeLoader];
 	loader.delegate = self;
 	self.loaderInProgress = loader;
+	// Set up here, on the main thread, before the loader's thread asks for it
+	[self loaderStoreCoordinator];
+#ifdef STORE_LOCK_TIMING
+	[self startLockTiming];
+#endif
 #if 1
 	// Asynchronous load in a separate thread
 	[loader start];
@@ -278,11 +377,68 @@ static const NSTimeInterval expireSeconds = 6 * 60 * 60;	// 6hr
 	NSLog(@"Finished loading %@; request %@ satisfied",
 		  self.requestInProgress,
 		  [self.requestInProgress isSatisfied] ? @"is" : @"NOT");	
+#ifdef REQUEST_COUNT_LOGGING
+	// Shows how many round trips batching saves
+	roundTrips++;
+	if ([(NSObject*)self.requestInProgress isKindOfClass:[PlaceBatchRequest class]]) {
+		placeRequestsLoaded += [[(PlaceBatchRequest*)self.requestInProgress requests] count];
+	} else if ([(NSObject*)self.requestInProgress isKindOfClass:[PlaceRequest class]]) {
+		placeRequestsLoaded++;
+	}
+	NSLog(@"%lu round trips so far, covering %lu place requests",
+		  (unsigned long)roundTrips, (unsigned long)placeRequestsLoaded);
+#endif
+#ifdef STORE_LOCK_TIMING
+	[self stopLockTiming];
+#endif
 	self.requestInProgress = nil;
 	self.loaderInProgress = nil;
 	[self checkQueue];
 }
 
+#ifdef STORE_LOCK_TIMING
+// Samples how long the main thread waits while a loader runs, as the latency of a small
+// rootContext fetch that has to read the store alongside the loader's saves. The loader saves
+// through its own coordinator, so any wait shows up here rather than on a coordinator lock.
+- (void)startLockTiming
+{
+	lockTimingSamples = 0;
+	lockTimingTotalFetch = 0.0;
+	lockTimingMaxFetch = 0.0;
+	lockTimingTimer = [[NSTimer scheduledTimerWithTimeInterval:0.02
+														target:self
+													  selector:@selector(sampleLockTiming:)
+													  userInfo:nil
+													   repeats:YES] retain];
+}
+
+- (void)sampleLockTiming:(NSTimer*)timer
+{
+	NSFetchRequest* request = [[[NSFetchRequest alloc] init] autorelease];
+	[request setEntity:[Place entity]];
+	[request setPredicate:[NSPredicate predicateWithFormat:@"obsCurrent != nil"]];
+	CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+	[self.rootContext countForFetchRequest:request error:NULL];
+	CFAbsoluteTime fetch = CFAbsoluteTimeGetCurrent() - start;
+	
+	lockTimingSamples++;
+	lockTimingTotalFetch += fetch;
+	lockTimingMaxFetch = MAX(lockTimingMaxFetch, fetch);
+}
+
+- (void)stopLockTiming
+{
+	[lockTimingTimer invalidate];
+	[lockTimingTimer release];
+	lockTimingTimer = nil;
+	if (lockTimingSamples > 0) {
+		NSLog(@"TIMING rootContext fetch during load: %lu samples, mean %.2f ms, max %.2f ms",
+			  (unsigned long)lockTimingSamples, 1000.0 * lockTimingTotalFetch / lockTimingSamples,
+			  1000.0 * lockTimingMaxFetch);
+	}
+}
+#endif
+
 - (void)clearQueue
 {
 	for (NSUInteger i = 0; i < [queue count]; ) {
@@ -348,26 +504,129 @@ static const NSTimeInterval expireSeconds = 6 * 60 * 60;	// 6hr
     if (coordinator != nil) {
         rootContext = [[NSManagedObjectContext alloc] init];
         [rootContext setPersistentStoreCoordinator: coordinator];
+		// Loaders save through their own coordinator, so this coordinator's row cache can be
+		// older than the store when their changes are merged. Always fire faults from the store.
+		[rootContext setStalenessInterval:0.0];
+		
+		[self startStoreBackfills];
     }
 	
     return rootContext;
 }
 
+// Converts, sorts and links data stored by earlier versions of the app, each once per store.
+// This runs on a thread of its own so that it does not hold up launch, and its saves are merged
+// into the rootContext like a loader's. Loading waits for it, so that saves cannot conflict.
+- (void)startStoreBackfills
+{
+	assert([NSThread isMainThread]);
+	NSPersistentStore* store = [[persistentStoreCoordinator persistentStores] lastObject];
+	NSDictionary* metadata = [persistentStoreCoordinator metadataForPersistentStore:store];
+	NSMutableArray* flags = [NSMutableArray array];
+	for (NSString* flag in [NSArray arrayWithObjects:kCustomMetadataMeasurementsCompacted,
+							kCustomMetadataSortAttributesSet, kCustomMetadataPlaceLinksBuilt, nil]) {
+		if (![metadata objectForKey:flag]) {
+			[flags addObject:flag];
+		}
+	}
+	if (!store || [flags count] == 0) {
+		return;
+	}
+	storeBackfillInProgress = YES;
+	// Set up here, on the main thread, before the backfill thread asks for it
+	[self loaderStoreCoordinator];
+	[NSThread detachNewThreadSelector:@selector(runStoreBackfills:) toTarget:self withObject:flags];
+}
+
+- (void)runStoreBackfills:(NSArray*)flags
+{
+	NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+	
+	NSPersistentStoreCoordinator* coordinator = [self loaderStoreCoordinator];
+	NSPersistentStore* store = [[coordinator persistentStores] lastObject];
+	NSManagedObjectContext* context = [[[NSManagedObjectContext alloc] init] autorelease];
+	[context setPersistentStoreCoordinator:coordinator];
+	
+	for (NSString* flag in flags) {
+		// Each backfill saves its flag along with the objects it changes
+		NSMutableDictionary* metadata = [[[coordinator metadataForPersistentStore:store] mutableCopy] autorelease];
+		[metadata setObject:@"YES" forKey:flag];
+		[coordinator setMetadata:metadata forPersistentStore:store];
+		
+		if ([flag isEqualToString:kCustomMetadataMeasurementsCompacted]) {
+			[Observation compactArchivedMeasurementsInContext:context];
+		} else if ([flag isEqualToString:kCustomMetadataSortAttributesSet]) {
+			// Needs the compacted measurements of the current observations
+			[Place updateMissingSortAttributesInContext:context];
+		} else if ([flag isEqualToString:kCustomMetadataPlaceLinksBuilt]) {
+			[PlaceLink rebuildLinksInContext:context];
+		}
+	}
+	
+	[self performSelectorOnMainThread:@selector(didFinishStoreBackfills:) withObject:flags waitUntilDone:NO];
+	[pool release];
+}
+
+- (void)didFinishStoreBackfills:(NSArray*)flags
+{
+	assert([NSThread isMainThread]);
+	// Keep the main coordinator's copy of the metadata in step, so that its saves keep the flags
+	NSPersistentStore* store = [[persistentStoreCoordinator persistentStores] lastObject];
+	NSMutableDictionary* metadata = [[[persistentStoreCoordinator metadataForPersistentStore:store] mutableCopy] autorelease];
+	for (NSString* flag in flags) {
+		[metadata setObject:@"YES" forKey:flag];
+	}
+	[persistentStoreCoordinator setMetadata:metadata forPersistentStore:store];
+	
+	NSLog(@"Finished store backfills %@", [flags componentsJoinedByString:@", "]);
+	storeBackfillInProgress = NO;
+	[self checkQueue];
+}
+
 
 /**
  Returns the managed object model for the application.
- If the model doesn't already exist, it is created by merging all of the
- models found in the application bundle.
+ If the model doesn't already exist, the current version of the Places model
+ is loaded from the application bundle. Stores of earlier versions migrate to
+ it automatically.
  */
 - (NSManagedObjectModel *)managedObjectModel
 {
     if (managedObjectModel != nil) {
         return managedObjectModel;
     }
-    managedObjectModel = [[NSManagedObjectModel mergedModelFromBundles:nil] retain];    
+    NSString* path = [[NSBundle mainBundle] pathForResource:@"Places" ofType:@"momd"];
+    managedObjectModel = [[NSManagedObjectModel alloc] initWithContentsOfURL:[NSURL fileURLWithPath:path]];
     return managedObjectModel;
 }
 
+- (NSPersistentStoreCoordinator *)loaderStoreCoordinator
+{
+	if (loaderStoreCoordinator != nil) {
+		return loaderStoreCoordinator;
+	}
+	assert([NSThread isMainThread]);
+	
+	// The main coordinator installs and migrates the store, so it must be set up first
+	NSPersistentStoreCoordinator* coordinator = [self persistentStoreCoordinator];
+	NSPersistentStore* store = [[coordinator persistentStores] lastObject];
+	
+	NSError *error = nil;
+	loaderStoreCoordinator = [[NSPersistentStoreCoordinator alloc]
+							  initWithManagedObjectModel:[self managedObjectModel]];
+	NSDictionary* options = [NSDictionary dictionaryWithObject:[self storePragmas] forKey:NSSQLitePragmasOption];
+	if (![loaderStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType
+											  configuration:nil
+														URL:[coordinator URLForPersistentStore:store]
+													options:options
+													  error:&error]) {
+		NSLog(@"ERROR adding store to loader coordinator, sharing the main one: %@", error);
+		[loaderStoreCoordinator release];
+		loaderStoreCoordinator = [coordinator retain];
+	}
+	return loaderStoreCoordinator;
+}
+
 - (NSString*)storePath
 {
 	return [[self applicationDocumentsDirectory] stringByAppendingPathComponent: @"Places.sqlite"];
@@ -378,17 +637,100 @@ static const NSTimeInterval expireSeconds = 6 * 60 * 60;	// 6hr
 	return [NSURL fileURLWithPath:[self storePath]];
 }
 
+/*
+ SQLite settings for every connection to the store.
+ In WAL mode the loader coordinator's saves append to the log while rootContext
+ fetches keep reading, rather than each blocking the other. SQLite versions before
+ WAL (iOS 4 and earlier) ignore journal_mode=WAL and the WAL specific pragmas, and
+ mmap_size is ignored before SQLite 3.7.17.
+ The mapping is sized from the store on disk, with room for it to double as charts
+ are loaded, within kMinStoreMapBytes and kMaxStoreMapBytes.
+ */
+- (NSDictionary*)storePragmas
+{
+	NSDictionary* attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:[self storePath] error:NULL];
+	unsigned long long mapBytes = 2 * [attributes fileSize];
+	mapBytes = MIN(MAX(mapBytes, kMinStoreMapBytes), kMaxStoreMapBytes);
+	
+	return [NSDictionary dictionaryWithObjectsAndKeys:
+			@"WAL", @"journal_mode",
+			@"NORMAL", @"synchronous",			// durable at checkpoints, which is enough for cached server data
+			@"500", @"cache_size",				// pages per connection
+			@"500", @"wal_autocheckpoint",		// pages, keeps the log small so reads stay quick
+			[NSString stringWithFormat:@"%llu", mapBytes], @"mmap_size",	// bytes
+			nil];
+}
+
+// Removes the store with its WAL and shared memory files, which must never outlive it.
+- (void)removeStoreFiles
+{
+	NSFileManager *fileManager = [NSFileManager defaultManager];
+	NSString* storePath = [self storePath];
+	[fileManager removeItemAtPath:storePath error:nil];
+	[fileManager removeItemAtPath:[storePath stringByAppendingString:@"-wal"] error:nil];
+	[fileManager removeItemAtPath:[storePath stringByAppendingString:@"-shm"] error:nil];
+}
+
 - (void)installDefaultStore
 {
 	NSString *defaultStorePath = [[NSBundle mainBundle] pathForResource:@"Places" ofType:@"sqlite"];
-	if (defaultStorePath) {
-		NSLog(@"Copying default store into place.");
-		NSFileManager *fileManager = [NSFileManager defaultManager];
-		[fileManager removeItemAtPath:[self storePath] error:nil];
-		[fileManager copyItemAtPath:defaultStorePath toPath:[self storePath] error:NULL];
-	} else {
+	if (!defaultStorePath) {
 		NSLog(@"Default store not found.");
+		return;
 	}
+	NSFileManager *fileManager = [NSFileManager defaultManager];
+	[self removeStoreFiles];
+	
+	NSURL* defaultStoreURL = [NSURL fileURLWithPath:defaultStorePath];
+	NSError* error = nil;
+	NSDictionary* metadata = [NSPersistentStoreCoordinator metadataForPersistentStoreOfType:NSSQLiteStoreType
+																					   URL:defaultStoreURL
+																					 error:&error];
+	NSManagedObjectModel* model = [self managedObjectModel];
+	NSManagedObjectModel* sourceModel = metadata ? [NSManagedObjectModel mergedModelFromBundles:nil forStoreMetadata:metadata] : nil;
+	
+	if (metadata && ![model isConfiguration:nil compatibleWithStoreMetadata:metadata] && sourceModel &&
+		[NSMappingModel respondsToSelector:@selector(inferredMappingModelForSourceModel:destinationModel:error:)]) {
+		// Migrating straight out of the bundle writes the store once, where copying it first
+		// would write it again when it is migrated in place.
+		NSLog(@"Migrating default store into place.");
+		NSMappingModel* mapping = [NSMappingModel inferredMappingModelForSourceModel:sourceModel
+																	destinationModel:model
+																			   error:&error];
+		NSMigrationManager* migration = [[[NSMigrationManager alloc] initWithSourceModel:sourceModel
+																		destinationModel:model] autorelease];
+		if (mapping && [migration migrateStoreFromURL:defaultStoreURL
+												 type:NSSQLiteStoreType
+											  options:nil
+									 withMappingModel:mapping
+									 toDestinationURL:[self storeURL]
+									  destinationType:NSSQLiteStoreType
+								   destinationOptions:nil
+												error:&error]) {
+			// Migration does not carry over our own metadata flags
+			NSMutableDictionary* newMetadata = [[[NSPersistentStoreCoordinator metadataForPersistentStoreOfType:NSSQLiteStoreType
+																											URL:[self storeURL]
+																										  error:&error] mutableCopy] autorelease];
+			for (NSString* key in metadata) {
+				if (![newMetadata objectForKey:key]) {
+					[newMetadata setObject:[metadata objectForKey:key] forKey:key];
+				}
+			}
+			if (newMetadata && [NSPersistentStoreCoordinator setMetadata:newMetadata
+												 forPersistentStoreOfType:NSSQLiteStoreType
+																	  URL:[self storeURL]
+																	error:&error]) {
+				return;
+			}
+		}
+		NSLog(@"Migrating default store failed, copying it instead: %@", error);
+		[self removeStoreFiles];
+	}
+	
+	// Either the default store already matches the model, in which case it opens as is, or it is
+	// migrated in place when added
+	NSLog(@"Copying default store into place.");
+	[fileManager copyItemAtPath:defaultStorePath toPath:[self storePath] error:NULL];
 }
 
 /**
@@ -418,6 +760,7 @@ static const NSTimeInterval expireSeconds = 6 * 60 * 60;	// 6hr
 	NSDictionary* options = [NSDictionary dictionaryWithObjectsAndKeys:
 							 [NSNumber numberWithBool:YES], NSMigratePersistentStoresAutomaticallyOption,
 							 [NSNumber numberWithBool:YES], NSInferMappingModelAutomaticallyOption,
+							 [self storePragmas], NSSQLitePragmasOption,
 							 nil];
 	
 	BOOL happy = NO;
@@ -464,7 +807,7 @@ static const NSTimeInterval expireSeconds = 6 * 60 * 60;	// 6hr
 	if (!happy) {
 		// Crap - the model differs from the default store. Should only happen in development.
 		// We start with a blank store.
-		[fileManager removeItemAtPath:[self storePath] error:nil];
+		[self removeStoreFiles];
 		NSLog(@"DEBUG Removed the store.");
 		
 		error = nil;
@@ -48,4 +48,8 @@
 - (BOOL)containsItem:(id)item;
 - (void)moveItemAtIndex:(NSUInteger)fromIndex toIndex:(NSUInteger)toIndex;
 
+// Brings the favourite places and their current observations into memory, and queues refreshes
+// of their observations and charts.
+- (void)prefetch;
+
 @end
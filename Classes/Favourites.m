@@ -81,17 +81,40 @@ static NSString* kFavouritesKey = @"favouritesData";
 - (id)initWithCoder:(NSCoder*)decoder
 {
 	if ((self = [super init])) {
-		self.items = [[[NSMutableArray alloc] init] autorelease];
-		NSArray* itemUrns = [decoder decodeObjectForKey:@"itemUrns"];
+		NSArray* itemUrns = [decoder decodeObjectForKey:@"itemUrns"] ?: [NSArray array];
 		NSManagedObjectContext* context = [[DataManager manager] rootContext];
-		for (NSString* urn in itemUrns) {
-			Place* place = [Place placeWithUrn:urn context:context];
-			[items addObject:place];
-		}
+		self.items = [[[Place placesWithUrns:itemUrns context:context] mutableCopy] autorelease];
 	}
 	return self;
 }
 
+- (void)prefetch
+{
+	assert([NSThread isMainThread]);
+	if ([items count] == 0) {
+		return;
+	}
+	// Pulls the favourites and their current observations back in with one fetch, in case they
+	// have been turned into faults since they were decoded
+	NSFetchRequest *fetchRequest = [[[NSFetchRequest alloc] init] autorelease];
+	[fetchRequest setEntity:[Place entity]];
+	[fetchRequest setPredicate:[NSPredicate predicateWithFormat:@"self in %@", items]];
+	[fetchRequest setRelationshipKeyPathsForPrefetching:[NSArray arrayWithObjects:@"obsCurrent", @"chart", nil]];
+	NSError* error = nil;
+	if (![[[DataManager manager] rootContext] executeFetchRequest:fetchRequest error:&error]) {
+		NSLog(@"ERROR Favourites prefetch: %@", error);
+	}
+	
+	// Only the favourites themselves, not their descendants. Queued behind anything already
+	// requested, and cleared like any other request when the user moves to a new view
+	for (Place* place in items) {
+		[[DataManager manager] loadPlace:place entire:NO force:NO];
+	}
+	for (Place* place in items) {
+		[[DataManager manager] loadChartForPlace:place force:NO];
+	}
+}
+
 - (void)encodeWithCoder:(NSCoder*)encoder
 {
 	NSMutableArray* itemUrns = [NSMutableArray array];
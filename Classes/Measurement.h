@@ -35,6 +35,8 @@
 @interface Measurement : NSObject <NSCoding> {
 	double value;
 	NSString* unit;
+	// Formatted text, indexed by format and forceSign. Guarded by @synchronized(self).
+	NSString* formattedText[4];
 }
 
 @property (nonatomic) double value;
@@ -42,10 +44,12 @@
 
 + (Measurement*)measurementWithUnit:(NSString*)unit value:(double)value;
 
-// Returns the measurement formatted as a percentage.
+// Returns the measurement formatted as a percentage, with one decimal place.
+// Formatted strings are kept until value or unit change. Safe to call from any thread.
 - (NSString*) textAsPercentageForceSign:(BOOL)forceSign;
 
-// Returns the measurement formatted as a volume.
+// Returns the measurement formatted as a volume, with thousands separators.
+// Formatted strings are kept until value or unit change. Safe to call from any thread.
 - (NSString*) textAsVolumeForceSign:(BOOL)forceSign;
 
 // Returns green if positive, red if negative, black if zero.
@@ -32,6 +32,63 @@
 #import "Measurement.h"
 
 
+enum MeasurementFormat {
+	MeasurementFormatPercentage = 0,
+	MeasurementFormatVolume = 2
+};
+
+
+// Formats x rounded to fractionDigits (0 or 1) decimal places, with "," as thousands
+// separator and "." as decimal point, like an NSNumberFormatter in the "en" locale: halves
+// round to even, and negative values that round to zero keep their sign, e.g. "-0".
+// Returns the length written to buffer.
+static size_t formatDecimal(double x, int fractionDigits, BOOL forceSign, char* buffer, size_t size)
+{
+	double scale = fractionDigits > 0 ? 10.0 : 1.0;
+	// rint rounds halves to even in the default rounding mode
+	double rounded = rint(x * scale);
+	BOOL negative = signbit(rounded) != 0;
+	unsigned long long magnitude = (unsigned long long)fabs(rounded);
+	unsigned long long integer = magnitude / (unsigned long long)scale;
+	
+	// Digits are written backwards from the end of a scratch buffer
+	char digits[40];
+	char* p = digits + sizeof(digits);
+	if (fractionDigits > 0) {
+		*--p = '0' + (char)(magnitude % 10);
+		*--p = '.';
+	}
+	int count = 0;
+	do {
+		if (count > 0 && count % 3 == 0) {
+			*--p = ',';
+		}
+		*--p = '0' + (char)(integer % 10);
+		integer /= 10;
+		count++;
+	} while (integer > 0);
+	if (negative) {
+		*--p = '-';
+	} else if (forceSign) {
+		*--p = '+';
+	}
+	
+	size_t length = digits + sizeof(digits) - p;
+	assert(length < size);
+	memcpy(buffer, p, length);
+	buffer[length] = '\0';
+	return length;
+}
+
+
+@interface Measurement ()	// private
+
+- (void)flushFormattedText;
+- (NSString*)textWithFormat:(enum MeasurementFormat)format forceSign:(BOOL)forceSign;
+
+@end
+
+
 @implementation Measurement
 
 @synthesize value;
@@ -39,6 +96,7 @@
 
 - (void)dealloc
 {
+	[self flushFormattedText];
 	[unit release];
 	[super dealloc];
 }
@@ -69,41 +127,69 @@
 	return m;
 }
 
-// Returns the measurement formatted as a percentage.
-- (NSString*) textAsPercentageForceSign:(BOOL)forceSign
+- (void)setValue:(double)newValue
 {
-	static NSNumberFormatter* formatter = nil;
-	if (formatter == nil) {
-		formatter = [[NSNumberFormatter alloc] init];
-		[formatter setNumberStyle:NSNumberFormatterDecimalStyle];
-		[formatter setLocale:[[[NSLocale alloc] initWithLocaleIdentifier:@"en"] autorelease]];
-		[formatter setMaximumFractionDigits:1];
-		[formatter setMinimumFractionDigits:1];
+	@synchronized(self) {
+		if (newValue != value) {
+			value = newValue;
+			[self flushFormattedText];
+		}
 	}
+}
 
-	double x = self.value;
-	if (x > -0.05 && x <= 0.0) {
-		// Eliminate "-0.0%"
-		x = +0.0;
+- (void)setUnit:(NSString*)newUnit
+{
+	@synchronized(self) {
+		if (newUnit != unit && ![newUnit isEqualToString:unit]) {
+			[unit release];
+			unit = [newUnit copy];
+			[self flushFormattedText];
+		}
+	}
+}
+
+- (void)flushFormattedText
+{
+	for (size_t i = 0; i < sizeof(formattedText) / sizeof(formattedText[0]); i++) {
+		[formattedText[i] release];
+		formattedText[i] = nil;
 	}
-	formatter.positivePrefix = forceSign ? @"+" : @"";
-	NSString* number = [formatter stringFromNumber:[NSNumber numberWithDouble:x]];
-	return [NSString stringWithFormat:@"%@%@", number, self.unit];
+}
+
+- (NSString*)textWithFormat:(enum MeasurementFormat)format forceSign:(BOOL)forceSign
+{
+	@synchronized(self) {
+		NSUInteger index = format + (forceSign ? 1 : 0);
+		if (!formattedText[index]) {
+			char number[40];
+			if (format == MeasurementFormatPercentage) {
+				double x = self.value;
+				if (x > -0.05 && x <= 0.0) {
+					// Eliminate "-0.0%"
+					x = +0.0;
+				}
+				formatDecimal(x, 1, forceSign, number, sizeof(number));
+				formattedText[index] = [[NSString alloc] initWithFormat:@"%s%@", number, self.unit ?: @""];
+			} else {
+				formatDecimal(self.value, 0, forceSign, number, sizeof(number));
+				formattedText[index] = [[NSString alloc] initWithFormat:@"%s %@", number, self.unit ?: @""];
+			}
+		}
+		// Outlive a concurrent change of value or unit
+		return [[formattedText[index] retain] autorelease];
+	}
+}
+
+// Returns the measurement formatted as a percentage.
+- (NSString*) textAsPercentageForceSign:(BOOL)forceSign
+{
+	return [self textWithFormat:MeasurementFormatPercentage forceSign:forceSign];
 }
 
 // Returns the measurement formatted as a volume.
 - (NSString*) textAsVolumeForceSign:(BOOL)forceSign
 {
-	static NSNumberFormatter* formatter = nil;
-	if (formatter == nil) {
-		formatter = [[NSNumberFormatter alloc] init];
-		[formatter setNumberStyle:NSNumberFormatterDecimalStyle];
-		[formatter setLocale:[[[NSLocale alloc] initWithLocaleIdentifier:@"en"] autorelease]];
-		[formatter setMaximumFractionDigits:0];
-	}
-	formatter.positivePrefix = forceSign ? @"+" : @"";
-	NSString* number = [formatter stringFromNumber:[NSNumber numberWithDouble:self.value]];
-	return [NSString stringWithFormat:@"%@ %@", number, self.unit];
+	return [self textWithFormat:MeasurementFormatVolume forceSign:forceSign];
 }
 
 - (UIColor*) changeColour
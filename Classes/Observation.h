@@ -36,8 +36,15 @@
 
 @interface Observation :  NSManagedObject  
 {
+	NSString* _capacityText;
+	NSString* _percentageVolumeText;
+	NSString* _volumeText;
+	Measurement* _measurements[5];	// in declaration order of the properties below
 }
 
+// Measurements are stored as a double and a unit string each, so that they can be
+// sorted and filtered in SQL, e.g. on "capacityValue". The Measurement objects are only views:
+// assign a new Measurement rather than changing a returned one.
 @property (nonatomic, retain) Measurement* capacity;
 @property (nonatomic, retain) Measurement* percentageVolume;
 @property (nonatomic, retain) Measurement* percentageVolumeChange;
@@ -46,6 +53,15 @@
 @property (nonatomic, retain) NSDate* observationDate;
 @property (nonatomic, retain) NSDate* loadDate;
 
+// Formatted measurements, or nil if the measurement is missing. Each string is formatted
+// once and kept until the observation changes or turns into a fault.
+@property (nonatomic, readonly) NSString* capacityText;
+@property (nonatomic, readonly) NSString* percentageVolumeText;
+@property (nonatomic, readonly) NSString* volumeText;
+
 + (NSEntityDescription*)entity;
 
+// Converts measurements still archived by an older version of the app, and saves the context.
++ (void)compactArchivedMeasurementsInContext:(NSManagedObjectContext*)context;
+
 @end
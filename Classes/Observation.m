@@ -31,15 +31,42 @@
 
 #import "Observation.h"
 #import "DataManager.h"
+#import "Measurement.h"
+#import "NSManagedObjectContext+Helpers.h"
+
+
+enum {
+	ObservationCapacity,
+	ObservationPercentageVolume,
+	ObservationPercentageVolumeChange,
+	ObservationVolume,
+	ObservationVolumeChange,
+	ObservationMeasurementCount
+};
+
+static NSString* const kValueKeys[ObservationMeasurementCount] = {
+	@"capacityValue", @"percentageVolumeValue", @"percentageVolumeChangeValue", @"volumeValue", @"volumeChangeValue"
+};
+static NSString* const kUnitKeys[ObservationMeasurementCount] = {
+	@"capacityUnit", @"percentageVolumeUnit", @"percentageVolumeChangeUnit", @"volumeUnit", @"volumeChangeUnit"
+};
+// Transformable attributes holding archived Measurements, as stored by earlier versions
+static NSString* const kArchivedKeys[ObservationMeasurementCount] = {
+	@"archivedCapacity", @"archivedPercentageVolume", @"archivedPercentageVolumeChange", @"archivedVolume", @"archivedVolumeChange"
+};
+
+
+@interface Observation ()	// private
+
+- (Measurement*)measurementAtIndex:(NSUInteger)index;
+- (void)setMeasurement:(Measurement*)measurement atIndex:(NSUInteger)index;
+- (void)flushCaches;
+
+@end
 
 
 @implementation Observation 
 
-@dynamic capacity;
-@dynamic percentageVolume;
-@dynamic percentageVolumeChange;
-@dynamic volume;
-@dynamic volumeChange;
 @dynamic observationDate;
 @dynamic loadDate;
 
@@ -55,4 +82,185 @@
 	return entity;
 }
 
++ (void)compactArchivedMeasurementsInContext:(NSManagedObjectContext*)context
+{
+	NSMutableArray* predicates = [NSMutableArray arrayWithCapacity:ObservationMeasurementCount];
+	for (NSUInteger i = 0; i < ObservationMeasurementCount; i++) {
+		[predicates addObject:[NSPredicate predicateWithFormat:@"%K != nil", kArchivedKeys[i]]];
+	}
+	NSFetchRequest* request = [[[NSFetchRequest alloc] init] autorelease];
+	[request setEntity:[self entity]];
+	[request setPredicate:[NSCompoundPredicate orPredicateWithSubpredicates:predicates]];
+	
+	NSError* error = nil;
+	NSArray* observations = [context executeFetchRequest:request error:&error];
+	if (!observations) {
+		NSLog(@"Could not fetch archived measurements: %@", error);
+		return;
+	}
+	for (Observation* observation in observations) {
+		for (NSUInteger i = 0; i < ObservationMeasurementCount; i++) {
+			Measurement* measurement = [observation valueForKey:kArchivedKeys[i]];
+			if (measurement) {
+				[observation setMeasurement:measurement atIndex:i];
+				[observation setValue:nil forKey:kArchivedKeys[i]];
+			}
+		}
+	}
+	if ([observations count] > 0) {
+		NSLog(@"Compacted the measurements of %u observations", (unsigned)[observations count]);
+		[context saveAndLogErrors];
+	}
+}
+
++ (NSSet*)keyPathsForValuesAffectingCapacity
+{
+	return [NSSet setWithObjects:kValueKeys[ObservationCapacity], kUnitKeys[ObservationCapacity], nil];
+}
+
++ (NSSet*)keyPathsForValuesAffectingPercentageVolume
+{
+	return [NSSet setWithObjects:kValueKeys[ObservationPercentageVolume], kUnitKeys[ObservationPercentageVolume], nil];
+}
+
++ (NSSet*)keyPathsForValuesAffectingPercentageVolumeChange
+{
+	return [NSSet setWithObjects:kValueKeys[ObservationPercentageVolumeChange], kUnitKeys[ObservationPercentageVolumeChange], nil];
+}
+
++ (NSSet*)keyPathsForValuesAffectingVolume
+{
+	return [NSSet setWithObjects:kValueKeys[ObservationVolume], kUnitKeys[ObservationVolume], nil];
+}
+
++ (NSSet*)keyPathsForValuesAffectingVolumeChange
+{
+	return [NSSet setWithObjects:kValueKeys[ObservationVolumeChange], kUnitKeys[ObservationVolumeChange], nil];
+}
+
+- (Measurement*)measurementAtIndex:(NSUInteger)index
+{
+	if (!_measurements[index]) {
+		NSNumber* value = [self valueForKey:kValueKeys[index]];
+		if (value) {
+			_measurements[index] = [[Measurement alloc] init];
+			_measurements[index].unit = [self valueForKey:kUnitKeys[index]];
+			_measurements[index].value = [value doubleValue];
+		}
+	}
+	return _measurements[index];
+}
+
+- (void)setMeasurement:(Measurement*)measurement atIndex:(NSUInteger)index
+{
+	NSNumber* value = nil;
+	NSString* unit = nil;
+	if (measurement) {
+		value = [NSNumber numberWithDouble:measurement.value];
+		unit = measurement.unit;
+	}
+	[self setValue:value forKey:kValueKeys[index]];
+	[self setValue:unit forKey:kUnitKeys[index]];
+}
+
+- (Measurement*)capacity
+{
+	return [self measurementAtIndex:ObservationCapacity];
+}
+
+- (void)setCapacity:(Measurement*)measurement
+{
+	[self setMeasurement:measurement atIndex:ObservationCapacity];
+}
+
+- (Measurement*)percentageVolume
+{
+	return [self measurementAtIndex:ObservationPercentageVolume];
+}
+
+- (void)setPercentageVolume:(Measurement*)measurement
+{
+	[self setMeasurement:measurement atIndex:ObservationPercentageVolume];
+}
+
+- (Measurement*)percentageVolumeChange
+{
+	return [self measurementAtIndex:ObservationPercentageVolumeChange];
+}
+
+- (void)setPercentageVolumeChange:(Measurement*)measurement
+{
+	[self setMeasurement:measurement atIndex:ObservationPercentageVolumeChange];
+}
+
+- (Measurement*)volume
+{
+	return [self measurementAtIndex:ObservationVolume];
+}
+
+- (void)setVolume:(Measurement*)measurement
+{
+	[self setMeasurement:measurement atIndex:ObservationVolume];
+}
+
+- (Measurement*)volumeChange
+{
+	return [self measurementAtIndex:ObservationVolumeChange];
+}
+
+- (void)setVolumeChange:(Measurement*)measurement
+{
+	[self setMeasurement:measurement atIndex:ObservationVolumeChange];
+}
+
+- (NSString*)capacityText
+{
+	if (!_capacityText) {
+		_capacityText = [[self.capacity textAsVolumeForceSign:NO] retain];
+	}
+	return _capacityText;
+}
+
+- (NSString*)percentageVolumeText
+{
+	if (!_percentageVolumeText) {
+		_percentageVolumeText = [[self.percentageVolume textAsPercentageForceSign:NO] retain];
+	}
+	return _percentageVolumeText;
+}
+
+- (NSString*)volumeText
+{
+	if (!_volumeText) {
+		_volumeText = [[self.volume textAsVolumeForceSign:NO] retain];
+	}
+	return _volumeText;
+}
+
+- (void)flushCaches
+{
+	for (NSUInteger i = 0; i < ObservationMeasurementCount; i++) {
+		[_measurements[i] release];
+		_measurements[i] = nil;
+	}
+	[_capacityText release];
+	_capacityText = nil;
+	[_percentageVolumeText release];
+	_percentageVolumeText = nil;
+	[_volumeText release];
+	_volumeText = nil;
+}
+
+- (void)didChangeValueForKey:(NSString*)key
+{
+	[super didChangeValueForKey:key];
+	[self flushCaches];
+}
+
+- (void)didTurnIntoFault
+{
+	[self flushCaches];
+	[super didTurnIntoFault];
+}
+
 @end
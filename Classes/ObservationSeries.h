@@ -0,0 +1,94 @@
+//
+//  ObservationSeries.h
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import <Foundation/Foundation.h>
+
+@class Place;
+
+enum ObservationField {
+	kObservationFieldVolume,		// in the unit of the place's capacity, normally megalitres
+	kObservationFieldPercentage,	// percentage of capacity, 0 to 100
+	kNumObservationFields
+};
+
+// The change of both fields between two days, NAN where either day is missing.
+typedef struct {
+	double volumeChange;
+	double percentageChange;
+} ObservationChange;
+
+// A place's daily volumes and percentages packed into dense arrays, one element per day from
+// firstDayIndex to lastDayIndex, with NAN for missing days. Day indexes are those of
+// DailyObservation. The series is a snapshot of what is stored locally, built from the place's
+// chart with its DailyObservation history on top, so changes over any period can be derived
+// without fetching the matching dailyObservations block. Chart volumes are left out when the
+// chart's capacity shows they are in another unit than the observations; percentages always agree.
+@interface ObservationSeries : NSObject
+{
+	NSInteger _firstDayIndex;
+	NSInteger _count;
+	double* _values[kNumObservationFields];
+}
+
+@property (nonatomic, readonly) NSInteger firstDayIndex;
+@property (nonatomic, readonly) NSInteger lastDayIndex;
+@property (nonatomic, readonly) NSInteger count;
+
+// Must be called on the thread of the place's context. Returns nil if nothing is stored.
++ (ObservationSeries*)seriesForPlace:(Place*)place;
+
+// Computes the change from daysBefore days earlier to dayIndex for each series in one pass.
+// changes must have room for [seriesArray count] elements.
++ (void)getChanges:(ObservationChange*)changes forSeries:(NSArray*)seriesArray
+		  dayIndex:(NSInteger)dayIndex daysBefore:(NSInteger)daysBefore;
+
+// Day index of the same calendar date the given number of months earlier, falling back to the
+// last day of shorter months.
++ (NSInteger)dayIndex:(NSInteger)dayIndex minusMonths:(NSInteger)months;
+
+// Direct access to the packed values, count elements long.
+- (const double*)valuesForField:(enum ObservationField)field;
+
+- (double)valueForField:(enum ObservationField)field dayIndex:(NSInteger)dayIndex;
+
+// The latest day on or before dayIndex with a value for field, or NSNotFound.
+- (NSInteger)lastDayIndexWithValueForField:(enum ObservationField)field onOrBefore:(NSInteger)dayIndex;
+
+- (ObservationChange)changeForDayIndex:(NSInteger)dayIndex daysBefore:(NSInteger)daysBefore;
+- (ObservationChange)yearOnYearChangeForDayIndex:(NSInteger)dayIndex;
+
+// Fills changes[i] with the change of field over daysBefore (>= 0) days ending on
+// firstDayIndex + i.
+- (void)getChanges:(double*)changes forField:(enum ObservationField)field daysBefore:(NSInteger)daysBefore;
+
+// Fills averages[i] with the mean of the available values of field over the window days ending
+// on firstDayIndex + i, or NAN if there are none.
+- (void)getRollingAverages:(double*)averages forField:(enum ObservationField)field window:(NSInteger)window;
+
+@end
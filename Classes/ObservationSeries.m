@@ -0,0 +1,295 @@
+//
+//  ObservationSeries.m
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import "ObservationSeries.h"
+#import "Place.h"
+#import "Chart.h"
+#import "ChartSeries.h"
+#import "ChartDataset.h"
+#import "ChartValue.h"
+#import "DailyObservation.h"
+#import "Observation.h"
+#import "Measurement.h"
+#import "CalendarHelpers.h"
+
+
+// Relative difference allowed between the chart's and the observations' capacity before the
+// chart's volumes are taken to be in another unit. Units differ by factors of a thousand.
+static const double kCapacityTolerance = 0.1;
+
+
+// Days from 1 Jan 1970 to the given proleptic gregorian date.
+static NSInteger dayIndexForCivilDate(NSInteger year, NSInteger month, NSInteger day)
+{
+	year -= month <= 2;
+	NSInteger era = (year >= 0 ? year : year - 399) / 400;
+	NSInteger yearOfEra = year - era * 400;
+	NSInteger dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	NSInteger dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	return era * 146097 + dayOfEra - 719468;
+}
+
+// Inverse of dayIndexForCivilDate.
+static void civilDateForDayIndex(NSInteger dayIndex, NSInteger* year, NSInteger* month, NSInteger* day)
+{
+	dayIndex += 719468;
+	NSInteger era = (dayIndex >= 0 ? dayIndex : dayIndex - 146096) / 146097;
+	NSInteger dayOfEra = dayIndex - era * 146097;
+	NSInteger yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+	NSInteger dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	NSInteger mp = (5 * dayOfYear + 2) / 153;
+	*day = dayOfYear - (153 * mp + 2) / 5 + 1;
+	*month = mp + (mp < 10 ? 3 : -9);
+	*year = yearOfEra + era * 400 + (*month <= 2);
+}
+
+// Chart days are laid out on a 366 day year, with day 60 repeating 28 Feb in common years.
+// Returns NSNotFound for that repeated day.
+static NSInteger dayIndexForChartDay(int year, int dayInYear)
+{
+	if (![NSCalendar isLeapYear:year]) {
+		if (dayInYear == 31 + 28 + 1) {
+			return NSNotFound;
+		} else if (dayInYear > 31 + 28 + 1) {
+			dayInYear--;
+		}
+	}
+	return dayIndexForCivilDate(year, 1, 1) + dayInYear - 1;
+}
+
+
+@interface ObservationSeries ()	// private
+
+- (id)initWithFirstDayIndex:(NSInteger)firstDayIndex lastDayIndex:(NSInteger)lastDayIndex;
+- (void)setValue:(double)value forField:(enum ObservationField)field dayIndex:(NSInteger)dayIndex;
+
+@end
+
+
+@implementation ObservationSeries
+
+@synthesize firstDayIndex = _firstDayIndex;
+@synthesize count = _count;
+
+- (id)initWithFirstDayIndex:(NSInteger)firstDayIndex lastDayIndex:(NSInteger)lastDayIndex
+{
+	if ((self = [super init])) {
+		_firstDayIndex = firstDayIndex;
+		_count = lastDayIndex - firstDayIndex + 1;
+		for (int field = 0; field < kNumObservationFields; field++) {
+			_values[field] = malloc(_count * sizeof(double));
+			for (NSInteger i = 0; i < _count; i++) {
+				_values[field][i] = NAN;
+			}
+		}
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	for (int field = 0; field < kNumObservationFields; field++) {
+		free(_values[field]);
+	}
+	[super dealloc];
+}
+
++ (ObservationSeries*)seriesForPlace:(Place*)place
+{
+	NSInteger firstDayIndex = NSIntegerMax;
+	NSInteger lastDayIndex = NSIntegerMin;
+	
+	// Find the extent of the chart datasets, which are contiguous runs of days
+	NSSet* chartSeries = place.chart.series;
+	for (ChartSeries* series in chartSeries) {
+		int year = [series.year intValue];
+		for (ChartDataset* set in series.datasets) {
+			NSArray* values = set.values;
+			if ([values count] > 0) {
+				// The repeated 28 Feb of a common year lies within the days either side of it
+				int startDay = ((ChartValue*)[values objectAtIndex:0]).dayInYear;
+				int endDay = ((ChartValue*)[values lastObject]).dayInYear;
+				NSInteger startDayIndex = dayIndexForChartDay(year, startDay);
+				NSInteger endDayIndex = dayIndexForChartDay(year, endDay);
+				firstDayIndex = MIN(firstDayIndex, startDayIndex != NSNotFound ? startDayIndex : dayIndexForChartDay(year, startDay - 1));
+				lastDayIndex = MAX(lastDayIndex, endDayIndex != NSNotFound ? endDayIndex : dayIndexForChartDay(year, endDay - 1));
+			}
+		}
+	}
+	
+	NSArray* history = [DailyObservation observationsForPlace:place fromDayIndex:NSIntegerMin toDayIndex:NSIntegerMax];
+	if ([history count] > 0) {
+		firstDayIndex = MIN(firstDayIndex, [((DailyObservation*)[history objectAtIndex:0]).dayIndex integerValue]);
+		lastDayIndex = MAX(lastDayIndex, [((DailyObservation*)[history lastObject]).dayIndex integerValue]);
+	}
+	if (firstDayIndex > lastDayIndex) {
+		return nil;
+	}
+	
+	ObservationSeries* result = [[[ObservationSeries alloc] initWithFirstDayIndex:firstDayIndex lastDayIndex:lastDayIndex] autorelease];
+	
+	// Chart volumes are in the unit of the chart's y axis, which need not be that of the
+	// observations (see ChartParser). yMax is the capacity in the chart's unit, so the volumes
+	// are only used when it matches the observed capacity.
+	Measurement* capacity = place.obsCurrent.capacity;
+	double chartCapacity = [place.chart.yMax doubleValue];
+	BOOL chartVolumesMatch = capacity && chartCapacity > 0.0
+		&& fabs(chartCapacity - capacity.value) <= kCapacityTolerance * capacity.value;
+	
+	for (ChartSeries* series in chartSeries) {
+		int year = [series.year intValue];
+		for (ChartDataset* set in series.datasets) {
+			for (ChartValue* value in set.values) {
+				NSInteger dayIndex = dayIndexForChartDay(year, value.dayInYear);
+				if (dayIndex != NSNotFound) {
+					if (chartVolumesMatch) {
+						[result setValue:value.value forField:kObservationFieldVolume dayIndex:dayIndex];
+					}
+					[result setValue:value.percentage * 100.0 forField:kObservationFieldPercentage dayIndex:dayIndex];
+				}
+			}
+		}
+	}
+	
+	// Observations are more precise than chart values, so they win for days in both
+	for (DailyObservation* day in history) {
+		NSInteger dayIndex = [day.dayIndex integerValue];
+		if (day.volume) {
+			[result setValue:[day.volume doubleValue] forField:kObservationFieldVolume dayIndex:dayIndex];
+		}
+		if (day.percentageVolume) {
+			[result setValue:[day.percentageVolume doubleValue] forField:kObservationFieldPercentage dayIndex:dayIndex];
+		}
+	}
+	return result;
+}
+
++ (void)getChanges:(ObservationChange*)changes forSeries:(NSArray*)seriesArray
+		  dayIndex:(NSInteger)dayIndex daysBefore:(NSInteger)daysBefore
+{
+	NSUInteger i = 0;
+	for (ObservationSeries* series in seriesArray) {
+		changes[i++] = [series changeForDayIndex:dayIndex daysBefore:daysBefore];
+	}
+}
+
++ (NSInteger)dayIndex:(NSInteger)dayIndex minusMonths:(NSInteger)months
+{
+	static const NSInteger daysInMonth[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	NSInteger year, month, day;
+	civilDateForDayIndex(dayIndex, &year, &month, &day);
+	NSInteger monthsSinceYearZero = year * 12 + month - 1 - months;
+	year = monthsSinceYearZero / 12;
+	month = monthsSinceYearZero % 12 + 1;
+	NSInteger lastDay = daysInMonth[month - 1] + (month == 2 && [NSCalendar isLeapYear:year] ? 1 : 0);
+	return dayIndexForCivilDate(year, month, MIN(day, lastDay));
+}
+
+- (NSInteger)lastDayIndex
+{
+	return _firstDayIndex + _count - 1;
+}
+
+- (const double*)valuesForField:(enum ObservationField)field
+{
+	return _values[field];
+}
+
+- (void)setValue:(double)value forField:(enum ObservationField)field dayIndex:(NSInteger)dayIndex
+{
+	_values[field][dayIndex - _firstDayIndex] = value;
+}
+
+- (double)valueForField:(enum ObservationField)field dayIndex:(NSInteger)dayIndex
+{
+	if (dayIndex < _firstDayIndex || dayIndex >= _firstDayIndex + _count) {
+		return NAN;
+	}
+	return _values[field][dayIndex - _firstDayIndex];
+}
+
+- (NSInteger)lastDayIndexWithValueForField:(enum ObservationField)field onOrBefore:(NSInteger)dayIndex
+{
+	const double* values = _values[field];
+	for (NSInteger i = MIN(dayIndex - _firstDayIndex, _count - 1); i >= 0; i--) {
+		if (!isnan(values[i])) {
+			return _firstDayIndex + i;
+		}
+	}
+	return NSNotFound;
+}
+
+- (ObservationChange)changeForDayIndex:(NSInteger)dayIndex daysBefore:(NSInteger)daysBefore
+{
+	ObservationChange change;
+	change.volumeChange = [self valueForField:kObservationFieldVolume dayIndex:dayIndex]
+		- [self valueForField:kObservationFieldVolume dayIndex:dayIndex - daysBefore];
+	change.percentageChange = [self valueForField:kObservationFieldPercentage dayIndex:dayIndex]
+		- [self valueForField:kObservationFieldPercentage dayIndex:dayIndex - daysBefore];
+	return change;
+}
+
+- (ObservationChange)yearOnYearChangeForDayIndex:(NSInteger)dayIndex
+{
+	return [self changeForDayIndex:dayIndex daysBefore:dayIndex - [ObservationSeries dayIndex:dayIndex minusMonths:12]];
+}
+
+- (void)getChanges:(double*)changes forField:(enum ObservationField)field daysBefore:(NSInteger)daysBefore
+{
+	NSParameterAssert(daysBefore >= 0);
+	const double* values = _values[field];
+	NSInteger start = MIN(daysBefore, _count);
+	for (NSInteger i = 0; i < start; i++) {
+		changes[i] = NAN;
+	}
+	// NAN propagates through the subtraction, so the loop has no branches
+	for (NSInteger i = start; i < _count; i++) {
+		changes[i] = values[i] - values[i - daysBefore];
+	}
+}
+
+- (void)getRollingAverages:(double*)averages forField:(enum ObservationField)field window:(NSInteger)window
+{
+	const double* values = _values[field];
+	double sum = 0.0;
+	NSInteger present = 0;
+	for (NSInteger i = 0; i < _count; i++) {
+		if (!isnan(values[i])) {
+			sum += values[i];
+			present++;
+		}
+		if (i >= window && !isnan(values[i - window])) {
+			sum -= values[i - window];
+			present--;
+		}
+		averages[i] = present > 0 ? sum / present : NAN;
+	}
+}
+
+@end
@@ -74,6 +74,13 @@ extern NSString* kNewPlaceNotification;
 @property (nonatomic, retain) NSSet* ascendants;
 @property (nonatomic, retain) NSSet* children;
 
+// PlaceLinks to all places above and below this one, at any depth.
+@property (nonatomic, retain) NSSet* ancestorLinks;
+@property (nonatomic, retain) NSSet* descendantLinks;
+
+// DailyObservations recorded for this place, see DailyObservation for queries.
+@property (nonatomic, retain) NSSet* history;
+
 // The current chart for this place.
 @property (nonatomic, retain) Chart* chart;
 
@@ -84,16 +91,37 @@ extern NSString* kNewPlaceNotification;
 @property (nonatomic, retain) Observation* obsPreviousMonth;
 @property (nonatomic, retain) Observation* obsPreviousYear;
 
+// Copies of type.priority, obsCurrent.capacityValue and obsCurrent.percentageVolumeValue,
+// indexed so that place lists sort and section in SQL without joins.
+// Kept up to date by the type and obsCurrent setters.
+@property (nonatomic, retain) NSNumber* sortPriority;
+@property (nonatomic, retain) NSNumber* sortCapacity;
+@property (nonatomic, retain) NSNumber* sortPercentage;
+
 /**
  If a place with this urn already exists, it is returned.
  If not, one is created and inserted into the context.
  */
 + (Place*)placeWithUrn:(NSString*)urn context:(NSManagedObjectContext*)context;
 
+/**
+ Returns the places with these urns, in the same order, fetching the existing
+ ones with their current observations in a single request.
+ Places that do not exist yet are created as by placeWithUrn:context:.
+ */
++ (NSArray*)placesWithUrns:(NSArray*)urns context:(NSManagedObjectContext*)context;
+
 + (Place*)australiaInContext:(NSManagedObjectContext*)context;
 
 + (NSEntityDescription*)entity;
 
+// Fills in the sort attributes of places stored before they existed, and saves the context.
++ (void)updateMissingSortAttributesInContext:(NSManagedObjectContext*)context;
+
+// Copies the current type priority and observation into the sort attributes.
+// Call after changing the current observation in place.
+- (void)updateSortAttributes;
+
 @end
 
 
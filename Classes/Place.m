@@ -31,6 +31,7 @@
 
 #import "Place.h"
 #import "PlaceType.h"
+#import "Observation.h"
 #import "DataManager.h"
 #import "NSManagedObjectContext+Helpers.h"
 
@@ -48,12 +49,18 @@ NSString* kNewPlaceNotification = @"NewPlace";
 @dynamic type;
 @dynamic ascendants;
 @dynamic children;
+@dynamic ancestorLinks;
+@dynamic descendantLinks;
+@dynamic history;
 @dynamic chart;
 @dynamic obsCurrent;
 @dynamic obsPreviousDay;
 @dynamic obsPreviousWeek;
 @dynamic obsPreviousMonth;
 @dynamic obsPreviousYear;
+@dynamic sortPriority;
+@dynamic sortCapacity;
+@dynamic sortPercentage;
 
 + (Place*)placeWithUrn:(NSString*)urn context:(NSManagedObjectContext*)context
 {
@@ -93,6 +100,33 @@ NSString* kNewPlaceNotification = @"NewPlace";
 	return place;
 }
 
++ (NSArray*)placesWithUrns:(NSArray*)urns context:(NSManagedObjectContext*)context
+{
+	assert(context);
+	
+	NSFetchRequest *fetchRequest = [[[NSFetchRequest alloc] init] autorelease];
+	[fetchRequest setEntity:[Place entity]];
+	[fetchRequest setPredicate:[NSPredicate predicateWithFormat:@"urn in %@", urns]];
+	[fetchRequest setRelationshipKeyPathsForPrefetching:[NSArray arrayWithObject:@"obsCurrent"]];
+	
+	NSError *error = nil;
+	NSArray *fetchedObjects = [context executeFetchRequest:fetchRequest error:&error];
+	if (fetchedObjects == nil) {
+		NSLog(@"ERROR placesWithUrns:context: %@", error);
+	}
+	NSMutableDictionary* placesByUrn = [NSMutableDictionary dictionaryWithCapacity:[fetchedObjects count]];
+	for (Place* place in fetchedObjects) {
+		[placesByUrn setObject:place forKey:place.urn];
+	}
+	
+	NSMutableArray* places = [NSMutableArray arrayWithCapacity:[urns count]];
+	for (NSString* urn in urns) {
+		Place* place = [placesByUrn objectForKey:urn];
+		[places addObject:place ?: [Place placeWithUrn:urn context:context]];
+	}
+	return places;
+}
+
 + (Place*)australiaInContext:(NSManagedObjectContext*)context
 {
 	return [Place placeWithUrn:@"urn:bom.gov.au:awris:common:codelist:region.country:australia" context:context];
@@ -110,4 +144,57 @@ NSString* kNewPlaceNotification = @"NewPlace";
 	return entity;
 }
 
++ (void)updateMissingSortAttributesInContext:(NSManagedObjectContext*)context
+{
+	NSFetchRequest* fetchRequest = [[[NSFetchRequest alloc] init] autorelease];
+	[fetchRequest setEntity:[Place entity]];
+	[fetchRequest setPredicate:[NSPredicate predicateWithFormat:@"sortPriority == nil && type != nil"]];
+	[fetchRequest setRelationshipKeyPathsForPrefetching:[NSArray arrayWithObjects:@"type", @"obsCurrent", nil]];
+	
+	NSError* error = nil;
+	NSArray* places = [context executeFetchRequest:fetchRequest error:&error];
+	if (error != nil) {
+		NSLog(@"ERROR updateMissingSortAttributesInContext: %@", error);
+	}
+	for (Place* place in places) {
+		[place updateSortAttributes];
+	}
+	if ([places count] > 0) {
+		[context saveAndLogErrors];
+	}
+}
+
+- (void)updateSortAttributes
+{
+	NSNumber* priority = self.type.priority;
+	NSNumber* capacity = [self.obsCurrent valueForKey:@"capacityValue"];
+	NSNumber* percentage = [self.obsCurrent valueForKey:@"percentageVolumeValue"];
+	// Avoid dirtying unchanged places
+	if (![priority isEqual:self.sortPriority] && priority != self.sortPriority) {
+		self.sortPriority = priority;
+	}
+	if (![capacity isEqual:self.sortCapacity] && capacity != self.sortCapacity) {
+		self.sortCapacity = capacity;
+	}
+	if (![percentage isEqual:self.sortPercentage] && percentage != self.sortPercentage) {
+		self.sortPercentage = percentage;
+	}
+}
+
+- (void)setType:(PlaceType*)type
+{
+	[self willChangeValueForKey:@"type"];
+	[self setPrimitiveValue:type forKey:@"type"];
+	[self didChangeValueForKey:@"type"];
+	[self updateSortAttributes];
+}
+
+- (void)setObsCurrent:(Observation*)observation
+{
+	[self willChangeValueForKey:@"obsCurrent"];
+	[self setPrimitiveValue:observation forKey:@"obsCurrent"];
+	[self didChangeValueForKey:@"obsCurrent"];
+	[self updateSortAttributes];
+}
+
 @end
@@ -0,0 +1,89 @@
+//
+//  PlaceBatchRequest.m
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import "PlaceBatchRequest.h"
+#import "PlaceRequest.h"
+#import "PlaceLoader.h"
+#import "Place.h"
+
+
+@implementation PlaceBatchRequest
+
+@synthesize requests;
+
+- (void)dealloc
+{
+	[requests release];
+	[super dealloc];
+}
+
+- (DataLoader*)makeLoader
+{
+	NSMutableArray* placeIDs = [NSMutableArray arrayWithCapacity:[requests count]];
+	for (PlaceRequest* request in requests) {
+		[placeIDs addObject:[request.place objectID]];
+	}
+	return [[[PlaceLoader alloc] initWithPlaceIDs:placeIDs] autorelease];
+}
+
+- (BOOL)isSatisfied
+{
+	for (PlaceRequest* request in requests) {
+		if (![request isSatisfied]) {
+			return NO;
+		}
+	}
+	return YES;
+}
+
+- (BOOL)isClearable
+{
+	for (PlaceRequest* request in requests) {
+		if (![request isClearable]) {
+			return NO;
+		}
+	}
+	return YES;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"batch of %@", [[requests valueForKey:@"description"] componentsJoinedByString:@", "]];
+}
+
++ (PlaceBatchRequest*)batchRequestWithRequests:(NSArray*)requests
+{
+	assert([NSThread isMainThread]);
+	PlaceBatchRequest* request = [[[PlaceBatchRequest alloc] init] autorelease];
+	request.requests = requests;
+	request.isForceLoad = [[requests valueForKeyPath:@"@max.isForceLoad"] boolValue];
+	return request;
+}
+
+@end
@@ -32,8 +32,12 @@
 #import <UIKit/UIKit.h>
 
 @class Place;
+@class PlaceCellContentView;
 
 
+// The labels loaded from the nib are not displayed. They describe the text, style and layout
+// that a single content view draws in one pass, so they can still be adjusted by table view
+// controllers. The level bars are ordinary views in the cell's background views.
 @interface PlaceCell : UITableViewCell {
 	UILabel* nameLabel;
 	UILabel* capacityLabel;
@@ -43,6 +47,7 @@
 	UILabel* typeLabel;
 	UIView* levelBar;
 	UIView* selectedLevelBar;
+	PlaceCellContentView* contentDrawingView;
 	Place* place;
 }
 
@@ -34,11 +34,119 @@
 #import "PlaceType.h"
 #import "Observation.h"
 #import "Measurement.h"
+#import "SparklineCache.h"
+
+
+static UIColor* bomBrightBlueColour = nil;
+static UIColor* bomCharcoalColour = nil;
+
+
+// Draws the sparkline and labels of a PlaceCell in one drawRect:.
+@interface PlaceCellContentView : UIView
+{
+	PlaceCell* _cell;	// not retained, owns this view
+	UIImage* _sparkline;
+	BOOL _highlighted;
+}
+
+@property (nonatomic, retain) UIImage* sparkline;
+@property (nonatomic, getter=isHighlighted) BOOL highlighted;
+
+- (id)initWithFrame:(CGRect)frame cell:(PlaceCell*)cell;
+
+@end
 
 
 @interface PlaceCell ()	// private
 
 - (void)updatePlaceDetails;
+- (void)updateSparkline;
+
+@end
+
+
+@implementation PlaceCellContentView
+
+@synthesize sparkline = _sparkline;
+@synthesize highlighted = _highlighted;
+
+- (void)dealloc
+{
+	[_sparkline release];
+	[super dealloc];
+}
+
+- (id)initWithFrame:(CGRect)frame cell:(PlaceCell*)cell
+{
+	if ((self = [super initWithFrame:frame])) {
+		_cell = cell;
+		self.backgroundColor = [UIColor clearColor];
+		self.opaque = NO;
+		self.contentMode = UIViewContentModeRedraw;
+		self.userInteractionEnabled = NO;
+	}
+	return self;
+}
+
+- (void)setSparkline:(UIImage*)sparkline
+{
+	if (sparkline != _sparkline) {
+		[_sparkline release];
+		_sparkline = [sparkline retain];
+		[self setNeedsDisplay];
+	}
+}
+
+- (void)setHighlighted:(BOOL)highlighted
+{
+	if (highlighted != _highlighted) {
+		_highlighted = highlighted;
+		[self setNeedsDisplay];
+	}
+}
+
+- (void)drawLabel:(UILabel*)label inContext:(CGContextRef)context
+{
+	if (!label || label.hidden || [label.text length] == 0) {
+		return;
+	}
+	
+	CGContextSaveGState(context);
+	if (_highlighted && label.highlightedTextColor) {
+		[label.highlightedTextColor set];
+	} else {
+		[label.textColor set];
+		if (label.shadowColor) {
+			CGContextSetShadowWithColor(context, label.shadowOffset, 0.0f, label.shadowColor.CGColor);
+		}
+	}
+	// Single line, vertically centred like UILabel
+	CGRect frame = label.frame;
+	CGSize size = [label.text sizeWithFont:label.font forWidth:frame.size.width lineBreakMode:label.lineBreakMode];
+	frame.origin.y += floorf((frame.size.height - size.height) / 2.0f);
+	frame.size.height = size.height;
+	[label.text drawInRect:frame withFont:label.font lineBreakMode:label.lineBreakMode alignment:label.textAlignment];
+	CGContextRestoreGState(context);
+}
+
+- (void)drawRect:(CGRect)rect
+{
+	CGContextRef context = UIGraphicsGetCurrentContext();
+	
+	[self.sparkline drawInRect:self.bounds];
+	
+	UILabel* labels[] = {
+		_cell.nameLabel,
+		_cell.typeLabel,
+		_cell.capacityTitle,
+		_cell.capacityLabel,
+		_cell.volumeLabel,
+		_cell.percentLabel
+	};
+	for (size_t i = 0; i < sizeof(labels) / sizeof(labels[0]); i++) {
+		[self drawLabel:labels[i] inContext:context];
+	}
+}
 
 @end
 
@@ -57,6 +165,14 @@
 @synthesize place;
 
 
++ (void)initialize
+{
+	if (self == [PlaceCell class]) {
+		bomBrightBlueColour = [[UIColor alloc] initWithRed:0.0/255.0 green:121.0/255.0 blue:205.0/255.0 alpha:1.0];
+		bomCharcoalColour = [[UIColor alloc] initWithRed:16.0/255.0 green:29.0/255.0 blue:36.0/255.0 alpha:1.0];
+	}
+}
+
 - (void)dealloc
 {
 	[[NSNotificationCenter defaultCenter] removeObserver:self];
@@ -69,6 +185,7 @@
 	[typeLabel release];
 	[levelBar release];
 	[selectedLevelBar release];
+	[contentDrawingView release];
     [super dealloc];
 }
 
@@ -80,6 +197,39 @@
     return self;
 }
 
+- (void)awakeFromNib
+{
+	[super awakeFromNib];
+	
+	// Keep the nib's labels only as templates, see PlaceCellContentView. The level bars stay
+	// in the background views, which swap them when the cell is selected.
+	[nameLabel removeFromSuperview];
+	[capacityLabel removeFromSuperview];
+	[capacityTitle removeFromSuperview];
+	[percentLabel removeFromSuperview];
+	[volumeLabel removeFromSuperview];
+	[typeLabel removeFromSuperview];
+	
+	contentDrawingView = [[PlaceCellContentView alloc] initWithFrame:self.contentView.bounds cell:self];
+	contentDrawingView.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+	[self.contentView addSubview:contentDrawingView];
+	self.isAccessibilityElement = YES;
+	
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(sparklineAvailableNotification:) name:kSparklineAvailableNotification object:nil];
+}
+
+- (void)setHighlighted:(BOOL)highlighted animated:(BOOL)animated
+{
+	[super setHighlighted:highlighted animated:animated];
+	contentDrawingView.highlighted = highlighted || self.selected;
+}
+
+- (void)setSelected:(BOOL)selected animated:(BOOL)animated
+{
+	[super setSelected:selected animated:animated];
+	contentDrawingView.highlighted = selected || self.highlighted;
+}
+
 - (void)setPlace:(Place *)newPlace
 {
 	if (newPlace != place) {
@@ -100,12 +250,23 @@
 	}
 }
 
+- (void)sparklineAvailableNotification:(NSNotification*)notification
+{
+	if ([[notification object] isEqual:place.urn]) {
+		[self updateSparkline];
+	}
+}
+
+- (void)updateSparkline
+{
+	// Only cached images: nothing is drawn while scrolling
+	contentDrawingView.sparkline = [[SparklineCache sharedCache] sparklineForPlace:place days:kSparklineDaysQuarter];
+}
+
 - (void)updatePlaceDetails
 {
-	Measurement* measurement = place.obsCurrent.percentageVolume;
-	
-	UIColor *bomBrightBlueColour = [[[UIColor alloc] initWithRed:0.0/255.0 green:121.0/255.0 blue:205.0/255.0 alpha:1.0] autorelease];
-	UIColor *bomCharcoalColour = [[[UIColor alloc] initWithRed:16.0/255.0 green:29.0/255.0 blue:36.0/255.0 alpha:1.0] autorelease];
+	Observation* observation = place.obsCurrent;
+	Measurement* measurement = observation.percentageVolume;
 	
 	CGRect bar = self.levelBar.frame;
 	bar.size = CGSizeMake(320.0f * 0.01f * measurement.value, bar.size.height);
@@ -116,12 +277,19 @@
 	
 	self.nameLabel.text = place.longName;
 	self.typeLabel.text = place.type.singular;
-	[self.percentLabel setMeasurementAsPercentage:measurement forceSign:NO];
+	self.percentLabel.text = measurement ? observation.percentageVolumeText : @"--.-%";
 	self.percentLabel.textColor = measurement ? bomCharcoalColour : [UIColor grayColor];
-	[self.capacityLabel setMeasurementAsVolume:place.obsCurrent.capacity forceSign:NO];
-	self.capacityLabel.textColor = place.obsCurrent.capacity ? bomBrightBlueColour : [UIColor grayColor];
-	[self.volumeLabel setMeasurementAsVolume:place.obsCurrent.volume forceSign:NO];
-	self.volumeLabel.textColor = place.obsCurrent.volume ? bomBrightBlueColour : [UIColor grayColor];
+	self.capacityLabel.text = observation.capacity ? observation.capacityText : @"--- ML";
+	self.capacityLabel.textColor = observation.capacity ? bomBrightBlueColour : [UIColor grayColor];
+	self.volumeLabel.text = observation.volume ? observation.volumeText : @"--- ML";
+	self.volumeLabel.textColor = observation.volume ? bomBrightBlueColour : [UIColor grayColor];
+	
+	self.accessibilityLabel = [NSString stringWithFormat:@"%@, %@, %@",
+							   place.longName ?: @"",
+							   measurement ? observation.percentageVolumeText : @"no percentage",
+							   observation.volume ? [observation.volumeText stringByReplacingOccurrencesOfString:@"ML" withString:@"megalitres"] : @"no volume"];
+	[self updateSparkline];
+	[contentDrawingView setNeedsDisplay];
 }
 
 @end
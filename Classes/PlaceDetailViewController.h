@@ -63,6 +63,9 @@
 	BOOL _viewIsActive;
 
 	Place* _place;
+#ifdef PLACE_OPEN_TIMING
+	CFAbsoluteTime _openTime;
+#endif
 }
 
 @property (nonatomic, retain) IBOutlet UIView* headerView;
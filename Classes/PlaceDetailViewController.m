@@ -42,6 +42,8 @@
 #import "ChartViewController.h"
 #import "LandscapeViewController.h"
 #import "CalendarHelpers.h"
+#import "DailyObservation.h"
+#import "ObservationSeries.h"
 
 
 enum ChangePeriod {
@@ -66,6 +68,10 @@ static NSString* const changePeriodLabels[kNumChangePeriods] = {
 	@"LAST YEAR"
 };
 
+// Used to compute a change locally when the server has not sent it
+static const NSInteger changePeriodMonths[kNumChangePeriods] = { 0, 0, 1, 12 };
+static const NSInteger changePeriodDays[kNumChangePeriods] = { 1, 7, 0, 0 };
+
 static enum ChangePeriod currentChangePeriod = kChangePeriodYear;
 
 
@@ -76,6 +82,7 @@ static enum ChangePeriod currentChangePeriod = kChangePeriodYear;
 
 - (void)setWaterPositionForView:(UIView*)waterView percentage:(float)percentage;
 - (void)updatePlaceDetailsAnimated:(BOOL)animated;
+- (BOOL)getLocalChange:(ObservationChange*)change previousPercentage:(double*)previousPercentage;
 - (void)orientationChanged:(NSNotification *)notification;
 - (void)checkAndShowLandscapeChartIfNeeded;
 
@@ -157,6 +164,9 @@ static enum ChangePeriod currentChangePeriod = kChangePeriodYear;
 - (id)initWithPlace:(Place*)place;
 {
 	if ((self = [super initWithNibName:@"PlaceDetailView" bundle:nil])) {
+#ifdef PLACE_OPEN_TIMING
+		_openTime = CFAbsoluteTimeGetCurrent();
+#endif
 		self.place = place;
 
 		[[NSNotificationCenter defaultCenter] addObserver:self
@@ -242,10 +252,25 @@ static enum ChangePeriod currentChangePeriod = kChangePeriodYear;
 	self.dateLabel.text = [[self.place.obsCurrent.observationDate readableDateWithWeekDay] uppercaseString];
 	self.changePeriodLabel.text = changePeriodLabels[currentChangePeriod];
 	Observation* obsPrevious = [self.place valueForKey:changePeriodKeys[currentChangePeriod]];
-	[self.changePercentLabel setMeasurementAsPercentage:obsPrevious.percentageVolumeChange forceSign:YES];
-	self.changePercentLabel.textColor = [obsPrevious.percentageVolumeChange changeColour] ?: [UIColor grayColor];
-	[self.changeVolumeLabel setMeasurementAsVolume:obsPrevious.volumeChange forceSign:YES];
-	self.changeVolumeLabel.textColor = obsPrevious.volumeChange ? bomDarkBlueColour : [UIColor grayColor];
+	Measurement* percentageVolumeChange = obsPrevious.percentageVolumeChange;
+	Measurement* volumeChange = obsPrevious.volumeChange;
+	// If the change text is "-.-%", always show the secondary level as zero.
+	float previousPercent = percentageVolumeChange ? obsPrevious.percentageVolume.value : 0.0f;
+	ObservationChange localChange;
+	double localPreviousPercent;
+	if (!percentageVolumeChange && [self getLocalChange:&localChange previousPercentage:&localPreviousPercent]) {
+		if (!isnan(localChange.percentageChange)) {
+			percentageVolumeChange = [Measurement measurementWithUnit:@"%" value:localChange.percentageChange];
+			previousPercent = localPreviousPercent;
+		}
+		if (!volumeChange && !isnan(localChange.volumeChange)) {
+			volumeChange = [Measurement measurementWithUnit:self.place.obsCurrent.volume.unit value:localChange.volumeChange];
+		}
+	}
+	[self.changePercentLabel setMeasurementAsPercentage:percentageVolumeChange forceSign:YES];
+	self.changePercentLabel.textColor = [percentageVolumeChange changeColour] ?: [UIColor grayColor];
+	[self.changeVolumeLabel setMeasurementAsVolume:volumeChange forceSign:YES];
+	self.changeVolumeLabel.textColor = volumeChange ? bomDarkBlueColour : [UIColor grayColor];
 	self.contextLabel.text = @"";	// FIXME
 
 	if (animated) {
@@ -253,14 +278,36 @@ static enum ChangePeriod currentChangePeriod = kChangePeriodYear;
 		[UIView setAnimationDuration:1.0f];
 	}
 	[self setWaterPositionForView:self.mainWaterView percentage:self.place.obsCurrent.percentageVolume.value];
-	// If the change text is "-.-%", always show the secondary level as zero.
-	float previousPercent = obsPrevious.percentageVolumeChange ? obsPrevious.percentageVolume.value : 0.0f;
 	[self setWaterPositionForView:self.secondaryWaterView percentage:previousPercent];
 	if (animated) {
 		[UIView commitAnimations];
 	}
 }
 
+// Computes the change over the current change period from the observation history stored for
+// the place, for when its previous observation has not been loaded. Only the one recorded day at
+// the start of the period is fetched; its values are in the units of the current observation.
+- (BOOL)getLocalChange:(ObservationChange*)change previousPercentage:(double*)previousPercentage
+{
+	Observation* current = self.place.obsCurrent;
+	if (!current.observationDate) {
+		return NO;
+	}
+	NSInteger dayIndex = [DailyObservation dayIndexForDate:current.observationDate];
+	NSInteger previousDayIndex = [ObservationSeries dayIndex:dayIndex - changePeriodDays[currentChangePeriod]
+												 minusMonths:changePeriodMonths[currentChangePeriod]];
+	DailyObservation* previous = [DailyObservation observationForPlace:self.place onOrBeforeDayIndex:previousDayIndex];
+	if (!previous || [previous.dayIndex integerValue] != previousDayIndex) {
+		return NO;
+	}
+	change->volumeChange = current.volume && previous.volume
+		? current.volume.value - [previous.volume doubleValue] : NAN;
+	change->percentageChange = current.percentageVolume && previous.percentageVolume
+		? current.percentageVolume.value - [previous.percentageVolume doubleValue] : NAN;
+	*previousPercentage = previous.percentageVolume ? [previous.percentageVolume doubleValue] : NAN;
+	return YES;
+}
+
 - (IBAction)showNextChangePeriod
 {
 	currentChangePeriod = (currentChangePeriod + 1) % kNumChangePeriods;
@@ -298,8 +345,26 @@ static enum ChangePeriod currentChangePeriod = kChangePeriodYear;
 	[self setWaterPositionForView:self.mainWaterView percentage:0.0f];
 	[self setWaterPositionForView:self.secondaryWaterView percentage:0.0f];
 	[super viewWillAppear:animated];
+#ifdef PLACE_OPEN_TIMING
+	// Runs once the first frame with the fetched rows has been committed
+	[self performSelector:@selector(logOpenTiming) withObject:nil afterDelay:0.0];
+#endif
 }
 
+#ifdef PLACE_OPEN_TIMING
+
+- (void)logOpenTiming
+{
+	if (_openTime > 0.0) {
+		NSLog(@"Place open timing: %@ with %u children, %.1f ms to first frame",
+			  _place.longName, (unsigned)[[self.fetchedResultsController fetchedObjects] count],
+			  (CFAbsoluteTimeGetCurrent() - _openTime) * 1000.0);
+		_openTime = 0.0;
+	}
+}
+
+#endif
+
 - (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
 {
 	if (object == [UIApplication sharedApplication] && [keyPath isEqual:@"networkActivityIndicatorVisible"]) {
@@ -350,6 +415,17 @@ static enum ChangePeriod currentChangePeriod = kChangePeriodYear;
 
 #pragma mark Table view methods
 
+// Sections are keyed by type priority, named by the type of their places
+- (NSString *)tableView:(UITableView *)tableView titleForHeaderInSection:(NSInteger)section
+{
+	id <NSFetchedResultsSectionInfo> sectionInfo = [[self.fetchedResultsController sections] objectAtIndex:section];
+	if ([sectionInfo numberOfObjects] == 0) {
+		return nil;
+	}
+	Place* firstPlace = [[sectionInfo objects] objectAtIndex:0];
+	return firstPlace.type.plural;
+}
+
 // Provide custom section headers
 - (CGFloat)tableView:(UITableView *)tableView heightForHeaderInSection:(NSInteger)section
 {
@@ -422,14 +498,19 @@ static enum ChangePeriod currentChangePeriod = kChangePeriodYear;
 		types = [NSSet setWithObjects:nil];
 	}
 	
+	// Filter, sort and section on the denormalized type priority and capacity of Place,
+	// which are indexed columns of the Place table
 	NSPredicate *predicate = nil;
-	predicate = [NSPredicate predicateWithFormat:@"type in %@ && %@ in ascendants", types, _place];
+	predicate = [NSPredicate predicateWithFormat:@"sortPriority in %@ && %@ in ascendants", [types valueForKey:@"priority"], _place];
 	[fetchRequest setPredicate:predicate];
 
-	NSSortDescriptor *majorSort = [[[NSSortDescriptor alloc] initWithKey:@"type.priority" ascending:YES] autorelease];
-	NSSortDescriptor *minorSort = [[[NSSortDescriptor alloc] initWithKey:@"obsCurrent.capacity.value" ascending:NO] autorelease];
+	NSSortDescriptor *majorSort = [[[NSSortDescriptor alloc] initWithKey:@"sortPriority" ascending:YES] autorelease];
+	NSSortDescriptor *minorSort = [[[NSSortDescriptor alloc] initWithKey:@"sortCapacity" ascending:NO] autorelease];
 	[fetchRequest setSortDescriptors:[NSArray arrayWithObjects:majorSort, minorSort, nil]];
 	
+	// Only the visible rows are faulted in
+	[fetchRequest setFetchBatchSize:20];
+	
 	// PlaceCell displays obsCurrent
 	NSArray* prefetchKeys = [NSArray arrayWithObject:@"obsCurrent"];
 	[fetchRequest setRelationshipKeyPathsForPrefetching:prefetchKeys];
@@ -437,7 +518,7 @@ static enum ChangePeriod currentChangePeriod = kChangePeriodYear;
 	return [[[NSFetchedResultsController alloc]
 					 initWithFetchRequest:fetchRequest
 					 managedObjectContext:context
-					 sectionNameKeyPath:@"type.plural"
+					 sectionNameKeyPath:@"sortPriority"
 					 cacheName:nil] autorelease];
 }
 
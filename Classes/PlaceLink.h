@@ -0,0 +1,59 @@
+//
+//  PlaceLink.h
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import <CoreData/CoreData.h>
+
+@class Place;
+
+// One row of the closure table of the place hierarchy: ancestor is depth levels above
+// descendant, following the shortest chain of children. A place is not linked to itself.
+//
+// The table answers "everything below this place" questions with a single indexed query
+// on PlaceLink instead of walking children sets.
+@interface PlaceLink : NSManagedObject
+{
+}
+
+@property (nonatomic, retain) Place* ancestor;
+@property (nonatomic, retain) Place* descendant;
+@property (nonatomic, retain) NSNumber* depth;
+
++ (NSEntityDescription*)entity;
+
+// Adds or shortens the links implied by a batch of new children. Each edge is an array of a
+// parent and its child, all in one context. Fetches twice, however many edges there are.
++ (void)linkEdges:(NSArray*)edges;
+
+// Replaces all links with those implied by the children relationships, and saves the context.
++ (void)rebuildLinksInContext:(NSManagedObjectContext*)context;
+
+// Returns a request for the links from place to its descendants no more than maxDepth levels below.
++ (NSFetchRequest*)fetchRequestForDescendantsOfPlace:(Place*)place maximumDepth:(NSUInteger)maxDepth;
+
+@end
@@ -0,0 +1,251 @@
+//
+//  PlaceLink.m
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import "PlaceLink.h"
+#import "Place.h"
+#import "DataManager.h"
+#import "NSManagedObjectContext+Helpers.h"
+
+
+// Records depth in depths under key unless a depth at least as short is there. Returns YES if recorded.
+static BOOL recordShorterDepth(NSMutableDictionary* depths, id key, NSInteger depth)
+{
+	NSNumber* known = [depths objectForKey:key];
+	if (known && [known integerValue] <= depth) {
+		return NO;
+	}
+	[depths setObject:[NSNumber numberWithInteger:depth] forKey:key];
+	return YES;
+}
+
+
+@interface PlaceLink ()	// private
+
++ (NSString*)keyForAncestor:(Place*)ancestor descendant:(Place*)descendant;
++ (void)linkAncestor:(Place*)ancestor toDescendantsOf:(Place*)place depth:(NSInteger)depth
+		   visiting:(NSMutableDictionary*)links context:(NSManagedObjectContext*)context;
+
+@end
+
+
+@implementation PlaceLink
+
+@dynamic ancestor;
+@dynamic descendant;
+@dynamic depth;
+
++ (NSEntityDescription *)entity
+{
+	static NSEntityDescription* entity = nil;
+	
+	if (entity == nil) {
+		NSManagedObjectModel* model = [[DataManager manager] managedObjectModel];
+		entity = [[model entitiesByName] objectForKey:@"PlaceLink"];
+		[entity retain];
+	}
+	return entity;
+}
+
++ (NSString*)keyForAncestor:(Place*)ancestor descendant:(Place*)descendant
+{
+	return [NSString stringWithFormat:@"%p %p", ancestor, descendant];
+}
+
++ (void)linkEdges:(NSArray*)edges
+{
+	if ([edges count] == 0) {
+		return;
+	}
+	NSManagedObjectContext* context = [[[edges objectAtIndex:0] objectAtIndex:0] managedObjectContext];
+	NSError* error = nil;
+	
+	// Places by objectID, and the depths of the places above each parent and below each child
+	NSMutableDictionary* places = [NSMutableDictionary dictionary];
+	NSMutableDictionary* above = [NSMutableDictionary dictionary];
+	NSMutableDictionary* below = [NSMutableDictionary dictionary];
+	for (NSArray* edge in edges) {
+		Place* parent = [edge objectAtIndex:0];
+		Place* child = [edge objectAtIndex:1];
+		[places setObject:parent forKey:[parent objectID]];
+		[places setObject:child forKey:[child objectID]];
+		[above setObject:[NSMutableDictionary dictionary] forKey:[parent objectID]];
+		[below setObject:[NSMutableDictionary dictionary] forKey:[child objectID]];
+	}
+	
+	// Everything already above the parents and below the children
+	NSFetchRequest* request = [[[NSFetchRequest alloc] init] autorelease];
+	[request setEntity:[PlaceLink entity]];
+	[request setPredicate:[NSPredicate predicateWithFormat:@"descendant in %@ || ancestor in %@",
+						   [above allKeys], [below allKeys]]];
+	NSArray* nearLinks = [context executeFetchRequest:request error:&error];
+	if (!nearLinks) {
+		NSLog(@"ERROR linkEdges: %@", error);
+		return;
+	}
+	for (PlaceLink* link in nearLinks) {
+		NSManagedObjectID* ancestorID = [link.ancestor objectID];
+		NSManagedObjectID* descendantID = [link.descendant objectID];
+		[places setObject:link.ancestor forKey:ancestorID];
+		[places setObject:link.descendant forKey:descendantID];
+		[[above objectForKey:descendantID] setObject:link.depth forKey:ancestorID];
+		[[below objectForKey:ancestorID] setObject:link.depth forKey:descendantID];
+	}
+	
+	// The shortest depth of each implied link. Edges are applied in turn, keeping the places
+	// above each parent and below each child current, so that edges chained within the batch
+	// link through each other.
+	NSMutableDictionary* depths = [NSMutableDictionary dictionary];
+	NSMutableDictionary* pairs = [NSMutableDictionary dictionary];
+	for (NSArray* edge in edges) {
+		NSManagedObjectID* parentID = [[edge objectAtIndex:0] objectID];
+		NSManagedObjectID* childID = [[edge objectAtIndex:1] objectID];
+		NSMutableDictionary* ancestors = [NSMutableDictionary dictionaryWithDictionary:[above objectForKey:parentID]];
+		[ancestors setObject:[NSNumber numberWithInteger:0] forKey:parentID];
+		NSMutableDictionary* descendants = [NSMutableDictionary dictionaryWithDictionary:[below objectForKey:childID]];
+		[descendants setObject:[NSNumber numberWithInteger:0] forKey:childID];
+		
+		for (NSManagedObjectID* ancestorID in ancestors) {
+			for (NSManagedObjectID* descendantID in descendants) {
+				Place* ancestor = [places objectForKey:ancestorID];
+				Place* descendant = [places objectForKey:descendantID];
+				if (ancestor == descendant) {
+					NSLog(@"ERROR linkEdges: %@ would be its own ancestor", descendant.urn);
+					continue;
+				}
+				NSInteger depth = [[ancestors objectForKey:ancestorID] integerValue] + 1
+					+ [[descendants objectForKey:descendantID] integerValue];
+				NSString* key = [self keyForAncestor:ancestor descendant:descendant];
+				if (recordShorterDepth(depths, key, depth)) {
+					[pairs setObject:[NSArray arrayWithObjects:ancestor, descendant, nil] forKey:key];
+				}
+				NSMutableDictionary* aboveDescendant = [above objectForKey:descendantID];
+				if (aboveDescendant) {
+					recordShorterDepth(aboveDescendant, ancestorID, depth);
+				}
+				NSMutableDictionary* belowAncestor = [below objectForKey:ancestorID];
+				if (belowAncestor) {
+					recordShorterDepth(belowAncestor, descendantID, depth);
+				}
+			}
+		}
+	}
+	if ([pairs count] == 0) {
+		return;
+	}
+	
+	NSMutableSet* ancestors = [NSMutableSet set];
+	NSMutableSet* descendants = [NSMutableSet set];
+	for (NSArray* pair in [pairs allValues]) {
+		[ancestors addObject:[pair objectAtIndex:0]];
+		[descendants addObject:[pair objectAtIndex:1]];
+	}
+	[request setPredicate:[NSPredicate predicateWithFormat:@"ancestor in %@ && descendant in %@", ancestors, descendants]];
+	NSArray* existingLinks = [context executeFetchRequest:request error:&error];
+	if (!existingLinks) {
+		NSLog(@"ERROR linkEdges: %@", error);
+		return;
+	}
+	NSMutableDictionary* links = [NSMutableDictionary dictionaryWithCapacity:[existingLinks count]];
+	for (PlaceLink* link in existingLinks) {
+		[links setObject:link forKey:[self keyForAncestor:link.ancestor descendant:link.descendant]];
+	}
+	
+	for (NSString* key in pairs) {
+		NSArray* pair = [pairs objectForKey:key];
+		NSNumber* depth = [depths objectForKey:key];
+		PlaceLink* link = [links objectForKey:key];
+		if (!link) {
+			link = [[[PlaceLink alloc] initWithEntity:[PlaceLink entity] insertIntoManagedObjectContext:context] autorelease];
+			link.ancestor = [pair objectAtIndex:0];
+			link.descendant = [pair objectAtIndex:1];
+			link.depth = depth;
+		} else if ([depth intValue] < [link.depth intValue]) {
+			link.depth = depth;
+		}
+	}
+}
+
++ (void)linkAncestor:(Place*)ancestor toDescendantsOf:(Place*)place depth:(NSInteger)depth
+		   visiting:(NSMutableDictionary*)links context:(NSManagedObjectContext*)context
+{
+	for (Place* child in place.children) {
+		if (child == ancestor) {
+			continue;
+		}
+		NSString* key = [self keyForAncestor:ancestor descendant:child];
+		PlaceLink* link = [links objectForKey:key];
+		if (link && [link.depth intValue] <= depth) {
+			// Already reached by a path at least as short
+			continue;
+		}
+		if (!link) {
+			link = [[[PlaceLink alloc] initWithEntity:[PlaceLink entity] insertIntoManagedObjectContext:context] autorelease];
+			link.ancestor = ancestor;
+			link.descendant = child;
+			[links setObject:link forKey:key];
+		}
+		link.depth = [NSNumber numberWithInt:depth];
+		[self linkAncestor:ancestor toDescendantsOf:child depth:depth + 1 visiting:links context:context];
+	}
+}
+
++ (void)rebuildLinksInContext:(NSManagedObjectContext*)context
+{
+	NSError* error = nil;
+	NSFetchRequest* request = [[[NSFetchRequest alloc] init] autorelease];
+	[request setEntity:[PlaceLink entity]];
+	NSArray* oldLinks = [context executeFetchRequest:request error:&error];
+	for (PlaceLink* link in oldLinks) {
+		[context deleteObject:link];
+	}
+	
+	[request setEntity:[Place entity]];
+	[request setRelationshipKeyPathsForPrefetching:[NSArray arrayWithObject:@"children"]];
+	NSArray* places = [context executeFetchRequest:request error:&error];
+	if (!places) {
+		NSLog(@"ERROR rebuildLinksInContext: %@", error);
+		return;
+	}
+	NSMutableDictionary* links = [NSMutableDictionary dictionary];
+	for (Place* place in places) {
+		[self linkAncestor:place toDescendantsOf:place depth:1 visiting:links context:context];
+	}
+	NSLog(@"Rebuilt %u place links for %u places", (unsigned)[links count], (unsigned)[places count]);
+	[context saveAndLogErrors];
+}
+
++ (NSFetchRequest*)fetchRequestForDescendantsOfPlace:(Place*)place maximumDepth:(NSUInteger)maxDepth
+{
+	NSFetchRequest* request = [[[NSFetchRequest alloc] init] autorelease];
+	[request setEntity:[PlaceLink entity]];
+	[request setPredicate:[NSPredicate predicateWithFormat:@"ancestor == %@ && depth <= %@", place, [NSNumber numberWithUnsignedInteger:maxDepth]]];
+	return request;
+}
+
+@end
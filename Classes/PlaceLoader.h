@@ -32,11 +32,18 @@
 #import <Foundation/Foundation.h>
 #import "DataLoader.h"
 
+@class PlaceParser;
+
 @interface PlaceLoader : DataLoader
 {
-	NSManagedObjectID* _placeID;
+	NSArray* _placeIDs;
+	PlaceParser* _placeParser;
 }
 
 - (id)initWithPlaceID:(NSManagedObjectID *)placeID;
 
+// Loads several places in one request. The response holds a section for each place, each
+// starting with a <requestIdentifier> giving the place's URN.
+- (id)initWithPlaceIDs:(NSArray *)placeIDs;
+
 @end
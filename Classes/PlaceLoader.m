@@ -37,40 +37,63 @@
 
 @interface PlaceLoader ()	// private
 
-@property (nonatomic, retain) NSManagedObjectID* placeID;
+@property (nonatomic, retain) NSArray* placeIDs;
+@property (nonatomic, retain) PlaceParser* placeParser;
 
 @end
 
 
 @implementation PlaceLoader
 
-@synthesize placeID = _placeID;
+@synthesize placeIDs = _placeIDs;
+@synthesize placeParser = _placeParser;
 
 - (void)dealloc
 {
-	[_placeID release];
+	[_placeIDs release];
+	[_placeParser release];
 	[super dealloc];
 }
 
 - (id)initWithPlaceID:(NSManagedObjectID*)placeID
 {
-	assert(![placeID isTemporaryID]);
+	return [self initWithPlaceIDs:[NSArray arrayWithObject:placeID]];
+}
+
+- (id)initWithPlaceIDs:(NSArray*)placeIDs
+{
+	assert([placeIDs count] > 0);
 	if ((self = [super init])) {
-		self.placeID = placeID;
+		for (NSManagedObjectID* placeID in placeIDs) {
+			assert(![placeID isTemporaryID]);
+		}
+		self.placeIDs = placeIDs;
 	}
 	return self;
 }
 
 - (NSString*)resourcePath
 {
-	Place* place = (Place*)[self.context objectWithID:self.placeID];
-	return [@"resources/mobiledata/" stringByAppendingString:place.urn];
+	if ([self.placeIDs count] == 1) {
+		Place* place = (Place*)[self.context objectWithID:[self.placeIDs lastObject]];
+		return [@"resources/mobiledata/" stringByAppendingString:place.urn];
+	}
+	NSMutableArray* urns = [NSMutableArray arrayWithCapacity:[self.placeIDs count]];
+	for (NSManagedObjectID* placeID in self.placeIDs) {
+		[urns addObject:((Place*)[self.context objectWithID:placeID]).urn];
+	}
+	return [@"resources/mobiledata?urns=" stringByAppendingString:[urns componentsJoinedByString:@","]];
 }
 
 - (DataParser*)makeParser
 {
-	Place* place = (Place*)[self.context objectWithID:self.placeID];
-	return [[[PlaceParser alloc] initWithPlace:place context:self.context] autorelease];
+	// A batched response names the place of each of its sections
+	Place* place = nil;
+	if ([self.placeIDs count] == 1) {
+		place = (Place*)[self.context objectWithID:[self.placeIDs lastObject]];
+	}
+	self.placeParser = [[[PlaceParser alloc] initWithPlace:place context:self.context] autorelease];
+	return self.placeParser;
 }
 
 - (BOOL)shouldContinueWithStatusCode:(NSInteger)statusCode
@@ -95,8 +118,18 @@
 
 - (void)didFinishLoading
 {
-	Place* place = (Place*)[self.context objectWithID:self.placeID];
-	place.completeLoadDate = [NSDate date];
+	NSDate* now = [NSDate date];
+	if ([self.placeIDs count] == 1) {
+		Place* place = (Place*)[self.context objectWithID:[self.placeIDs lastObject]];
+		place.completeLoadDate = now;
+	} else {
+		// Places missing from a batched response stay due, and are requested again
+		for (Place* place in self.placeParser.requestedPlaces) {
+			if ([self.placeIDs containsObject:[place objectID]]) {
+				place.completeLoadDate = now;
+			}
+		}
+	}
 	[self.context saveAndLogErrors];
 }
 
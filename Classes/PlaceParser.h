@@ -42,8 +42,15 @@
 @private
 	Place* _mainPlace;
 	Place* _identifierPlace;
+	NSMutableSet* _requestedPlaces;
+	NSMutableArray* _childEdges;	// new (parent, child) pairs, linked in parseEnd
 }
 
+// The places named by the <requestIdentifier> elements parsed so far.
+@property (nonatomic, readonly) NSSet* requestedPlaces;
+
+// place is the place whose response is parsed, or nil for a batched response, in which each
+// <requestIdentifier> element names the place for the elements following it.
 - (id)initWithPlace:(Place*)place context:(NSManagedObjectContext*)context;
 
 @end
@@ -34,6 +34,8 @@
 #import "PlaceType.h"
 #import "Observation.h"
 #import "Measurement.h"
+#import "DailyObservation.h"
+#import "PlaceLink.h"
 #import "NSDictionary+XMLStreamParserHelpers.h"
 #import "NSManagedObjectContext+Helpers.h"
 #import "CalendarHelpers.h"
@@ -51,11 +53,14 @@
 
 @synthesize mainPlace = _mainPlace;
 @synthesize identifierPlace = _identiferPlace;
+@synthesize requestedPlaces = _requestedPlaces;
 
 - (void)dealloc
 {
 	[_mainPlace release];
 	[_identifierPlace release];
+	[_requestedPlaces release];
+	[_childEdges release];
 	[super dealloc];
 }
 
@@ -63,6 +68,9 @@
 {
 	if ((self = [super initWithContext:context])) {
 		self.mainPlace = place;
+		_requestedPlaces = [[NSMutableSet alloc] init];
+		_childEdges = [[NSMutableArray alloc] init];
+		[self setCompleteCallback:@selector(gotRequestIdentifier:) forElement:@"requestIdentifier"];
 		[self setCompleteCallback:@selector(gotIdentifier:) forElement:@"identifier"];
 		[self setCompleteCallback:@selector(gotRegionOrFeature:) forElement:@"region"];
 		[self setCompleteCallback:@selector(gotRegionOrFeature:) forElement:@"feature"];
@@ -80,6 +88,14 @@
 	NSLog(@"PlaceParser: %@", errorMsg);
 }
 
+- (void)parseEnd
+{
+	[super parseEnd];
+	// Updating the PlaceLink closure table once for the whole response saves fetches per child
+	[PlaceLink linkEdges:_childEdges];
+	[_childEdges removeAllObjects];
+}
+
 static NSNumber* numberFromString(NSString* string)
 {
 	static NSNumberFormatter* formatter = nil;
@@ -115,6 +131,34 @@ static NSNumber* numberFromString(NSString* string)
 	</feature>
 */
 
+/*
+ A batched response holds the response for each requested place in turn, each starting with
+ the URN it was requested by, e.g.:
+ 
+	<mobileDataBatch>
+		<SlakeMobilePlaceResponse>
+			<requestIdentifier>urn:bom.gov.au:awris:common:codelist:region.city:melbourne</requestIdentifier>
+			...
+		</SlakeMobilePlaceResponse>
+		<SlakeMobilePlaceResponse>
+			<requestIdentifier>urn:bom.gov.au:awris:common:codelist:feature:thomson</requestIdentifier>
+			...
+		</SlakeMobilePlaceResponse>
+	</mobileDataBatch>
+ 
+ <observations> blocks are matched to places by their own <identifier>, as in a single response.
+*/
+
+- (void)gotRequestIdentifier:(id)element
+{
+	if ([element isKindOfClass:[NSString class]]) {
+		self.mainPlace = [Place placeWithUrn:element context:self.context];
+		[_requestedPlaces addObject:self.mainPlace];
+	} else {
+		NSLog(@"Encountered <requestIdentifier> with subelements, expected string.");
+	}
+}
+
 - (void)gotIdentifier:(id)element
 {
 	if ([element isKindOfClass:[NSString class]]) {
@@ -149,7 +193,13 @@ static NSNumber* numberFromString(NSString* string)
 - (void)gotChildren:(id)element
 {
 	if ([element isKindOfClass:[NSDictionary class]]) {
-		[self.mainPlace addChildrenObject:self.identifierPlace];
+		Place* child = self.identifierPlace;
+		if (!self.mainPlace) {
+			NSLog(@"Encountered <children> before <requestIdentifier> in a batched response.");
+		} else if (child && ![self.mainPlace.children containsObject:child]) {
+			[self.mainPlace addChildrenObject:child];
+			[_childEdges addObject:[NSArray arrayWithObjects:self.mainPlace, child, nil]];
+		}
 		self.identifierPlace = nil;
 	}
 }
@@ -356,6 +406,7 @@ Measurement* measurementForElement(id element)
 	
 	
 	[place setValue:obs forKey:obsKey];
+	[DailyObservation recordObservation:obs forPlace:place];
 	
 	if ([obsKey isEqualToString:@"obsCurrent"]) {
 		NSLog(@"%@: %@", place.longName, [place.obsCurrent.percentageVolume textAsPercentageForceSign:NO] ?: @"--.-%");
@@ -35,6 +35,14 @@
 #import "Observation.h"
 #import "DataManager.h"
 #import "PlaceLoader.h"
+#import "PlaceLink.h"
+
+
+@interface PlaceRequest ()	// private
+
+- (BOOL)getEarliestChildLoadDate:(NSDate**)date;
+
+@end
 
 
 @implementation PlaceRequest
@@ -65,11 +73,11 @@
 		// The place details and current obs for all
 		// the children must also be up to date.
 		date = [date earlierDate:self.place.completeLoadDate];
-		for (Place* child in self.place.children) {
-			NSDate* childDate = child.obsCurrent.loadDate;
-			if (!childDate) {
-				return NO;
-			}
+		NSDate* childDate = nil;
+		if (![self getEarliestChildLoadDate:&childDate]) {
+			return NO;
+		}
+		if (childDate) {
 			date = [date earlierDate:childDate];
 		}
 	}
@@ -85,6 +93,47 @@
 #endif
 }
 
+// Finds the earliest current observation of the children with two aggregate queries on the
+// PlaceLink table, instead of faulting every child and its observation.
+// Returns NO if a child has no current observation yet.
+- (BOOL)getEarliestChildLoadDate:(NSDate**)date
+{
+	*date = nil;
+	NSManagedObjectContext* context = [self.place managedObjectContext];
+	NSFetchRequest* request = [PlaceLink fetchRequestForDescendantsOfPlace:self.place maximumDepth:1];
+	NSPredicate* childPredicate = [request predicate];
+	NSPredicate* missingPredicate = [NSPredicate predicateWithFormat:@"descendant.obsCurrent == nil || descendant.obsCurrent.loadDate == nil"];
+	[request setPredicate:[NSCompoundPredicate andPredicateWithSubpredicates:
+						   [NSArray arrayWithObjects:childPredicate, missingPredicate, nil]]];
+	
+	NSError* error = nil;
+	NSUInteger missing = [context countForFetchRequest:request error:&error];
+	if (missing == NSNotFound) {
+		NSLog(@"ERROR counting children without observations: %@", error);
+		return NO;
+	}
+	if (missing > 0) {
+		return NO;
+	}
+	
+	NSExpression* loadDate = [NSExpression expressionForKeyPath:@"descendant.obsCurrent.loadDate"];
+	NSExpressionDescription* earliest = [[[NSExpressionDescription alloc] init] autorelease];
+	[earliest setName:@"earliest"];
+	[earliest setExpression:[NSExpression expressionForFunction:@"min:" arguments:[NSArray arrayWithObject:loadDate]]];
+	[earliest setExpressionResultType:NSDateAttributeType];
+	[request setPredicate:childPredicate];
+	[request setResultType:NSDictionaryResultType];
+	[request setPropertiesToFetch:[NSArray arrayWithObject:earliest]];
+	
+	NSArray* results = [context executeFetchRequest:request error:&error];
+	if (!results) {
+		NSLog(@"ERROR fetching earliest child observation: %@", error);
+		return NO;
+	}
+	*date = [[results lastObject] objectForKey:@"earliest"];
+	return YES;
+}
+
 - (BOOL)isClearable
 {
 	return self.place.completeLoadDate != nil;
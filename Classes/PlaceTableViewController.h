@@ -57,4 +57,10 @@
 // Subclass must override and set cell.place at minimum. Default implementation does nothing.
 - (void)configurePlaceCell:(PlaceCell *)cell atIndexPath:(NSIndexPath *)indexPath;
 
+#ifdef PLACE_SCROLL_TIMING
+// Scrolls through the whole table, laying out and drawing the visible cells for every
+// frame, and logs the time spent on each frame.
+- (void)runScrollTiming;
+#endif
+
 @end
@@ -32,6 +32,10 @@
 #import "PlaceTableViewController.h"
 #import "PlaceCell.h"
 
+#ifdef PLACE_SCROLL_TIMING
+#import <QuartzCore/QuartzCore.h>
+#endif
+
 
 @implementation PlaceTableViewController
 
@@ -76,6 +80,60 @@
 	self.placeCell = nil;
 }
 
+#ifdef PLACE_SCROLL_TIMING
+
+- (void)viewDidAppear:(BOOL)animated
+{
+	[super viewDidAppear:animated];
+	[self performSelector:@selector(runScrollTiming) withObject:nil afterDelay:1.0];
+}
+
+static void displayLayerTree(CALayer* layer)
+{
+	[layer displayIfNeeded];
+	for (CALayer* sublayer in layer.sublayers) {
+		displayLayerTree(sublayer);
+	}
+}
+
+- (void)runScrollTiming
+{
+	assert([NSThread isMainThread]);
+	//a brisk flick covers about 480 points per second
+	CGFloat step = 8.0f;
+	UITableView* tableView = self.tableView;
+	CGFloat maxOffset = tableView.contentSize.height - tableView.bounds.size.height;
+	
+	NSUInteger frames = 0;
+	NSUInteger slowFrames = 0;
+	NSTimeInterval total = 0.0;
+	NSTimeInterval worst = 0.0;
+	for (CGFloat offset = 0.0f; offset <= maxOffset; offset += step) {
+		CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+		tableView.contentOffset = CGPointMake(0.0f, offset);
+		[tableView layoutIfNeeded];
+		for (UITableViewCell* cell in [tableView visibleCells]) {
+			displayLayerTree(cell.layer);
+		}
+		NSTimeInterval elapsed = CFAbsoluteTimeGetCurrent() - start;
+		total += elapsed;
+		worst = MAX(worst, elapsed);
+		frames++;
+		if (elapsed > 1.0 / 60.0) {
+			slowFrames++;
+		}
+	}
+	tableView.contentOffset = CGPointZero;
+	
+	if (frames > 0) {
+		NSLog(@"Place scroll timing: %u rows, %u frames, mean %.3f ms, worst %.3f ms, %u over 60 fps budget",
+			  (unsigned)(tableView.contentSize.height / tableView.rowHeight), (unsigned)frames,
+			  total / frames * 1000.0, worst * 1000.0, (unsigned)slowFrames);
+	}
+}
+
+#endif
+
 
 #pragma mark Table view methods
 
@@ -39,6 +39,8 @@
 #import "Favourites.h"
 #import "AboutViewController.h"
 #import "SearchViewController.h"
+#import "SparklineCache.h"
+#import "ChartBudget.h"
 
 
 @interface SlakeAppDelegate ()	// private
@@ -83,6 +85,7 @@ static NSString* kTabOrderKey = @"tabOrder";
 static NSString* kSelectedTabTagKey = @"selectedTabTag";
 
 static float kSplashSeconds = 1.0f;
+static const NSTimeInterval kChartEvictionDelay = 30.0;
 
 
 - (id)navigationControllerForTabTag:(enum TabTag)tag
@@ -158,6 +161,8 @@ static float kSplashSeconds = 1.0f;
 	[PlaceType loadPlaceTypesInContext:context];
 	[Place australiaInContext:context].type = [PlaceType countryInContext:context];
 	[[DataManager manager] loadAllNewPlaces];
+	// Start watching for chart imports
+	[SparklineCache sharedCache];
 	
 	enum TabTag tabOrder[kNumTabs];
 	
@@ -195,6 +200,11 @@ static float kSplashSeconds = 1.0f;
 	[window addSubview:[tabBarController view]];
     [window makeKeyAndVisible];
 	
+	// Once the first screen is up
+	[[Favourites favourites] performSelector:@selector(prefetch) withObject:nil afterDelay:0.0];
+	// Deleting charts faults in their data, so wait until launch has settled
+	[[ChartBudget sharedBudget] performSelector:@selector(evictUnviewedCharts) withObject:nil afterDelay:kChartEvictionDelay];
+	
 	NSDate* endSplashDate = [launchDate addTimeInterval:kSplashSeconds];
 	[NSThread sleepUntilDate:endSplashDate];
 }
@@ -231,6 +241,7 @@ static float kSplashSeconds = 1.0f;
 {
 	NSLog(@"Resuming");
 	[[DataManager manager] resumeLoading];
+	[[Favourites favourites] prefetch];
 }
 
 
@@ -0,0 +1,88 @@
+//
+//  SparklineCache.h
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import <UIKit/UIKit.h>
+
+@class Chart;
+@class Place;
+
+// Posted on the main thread when a sparkline becomes available in memory.
+// The object is the URN of the place.
+extern NSString* const kSparklineAvailableNotification;
+
+// Sparkline spans in days, ending at the last day of the chart.
+enum {
+	kSparklineDaysMonth = 30,
+	kSparklineDaysQuarter = 90,
+	kSparklineDaysYear = 365
+};
+
+// Precomputed trend thumbnails for place lists.
+//
+// Sparklines for all spans are drawn in the background whenever a chart is imported into the
+// root context, and stored in a size-bounded disk cache keyed by place URN and chart loadDate,
+// so that a reloaded chart never shows a stale image. The load date of each imported chart is
+// recorded by the cache, so lookups only need the place URN: they never draw, read the disk
+// or fault the chart. A miss schedules the work and kSparklineAvailableNotification follows.
+@interface SparklineCache : NSObject
+{
+	NSOperationQueue* _queue;
+	NSMutableDictionary* _images;	// by URN and span
+	NSMutableArray* _recentKeys;	// keys of _images, least recently used first
+	NSMutableDictionary* _loadDates;	// chart loadDate in whole seconds by URN
+	NSMutableSet* _pendingKeys;	// file keys being loaded or drawn
+	NSMutableSet* _missingKeys;	// URNs generated once already, not drawn again when missing
+	NSString* _directory;
+	NSString* _loadDatesPath;
+	unsigned long long _maxDiskBytes;
+	// Disk cache index, only used on the queue
+	BOOL _diskIndexed;
+	NSMutableArray* _diskNames;	// file names, oldest first
+	NSMutableDictionary* _diskSizes;	// file sizes by name
+	unsigned long long _diskBytes;
+}
+
+// Oldest files are removed once the cache directory grows beyond this size. Defaults to 2 MB.
+@property (nonatomic, assign) unsigned long long maxDiskBytes;
+
+// Get the singleton.
++ (SparklineCache*)sharedCache;
+
+// Size in points of every sparkline.
++ (CGSize)sparklineSize;
+
+// The sparkline if it is in memory, otherwise nil. Safe to call while scrolling.
+- (UIImage*)sparklineForPlace:(Place*)place days:(NSInteger)days;
+
+// Draws and stores the sparklines for every span of the chart.
+- (void)generateSparklinesForChart:(Chart*)chart;
+
+- (void)removeAllSparklines;
+
+@end
@@ -0,0 +1,598 @@
+//
+//  SparklineCache.m
+//  Slake
+//
+//  Copyright (c) 2010 Bureau of Meteorology
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#import <ImageIO/ImageIO.h>
+#import "SparklineCache.h"
+#import "Chart.h"
+#import "ChartSeries.h"
+#import "ChartValue.h"
+#import "Place.h"
+#import "CalendarHelpers.h"
+#import "DataManager.h"
+#import "ChartBudget.h"
+
+NSString* const kSparklineAvailableNotification = @"SparklineAvailableNotification";
+
+static const CGFloat kSparklineWidth = 320.0f;
+static const CGFloat kSparklineHeight = 51.0f;
+static const NSUInteger kMaxImagesInMemory = 64;
+static const unsigned long long kDefaultMaxDiskBytes = 2 * 1024 * 1024;
+
+
+@interface SparklineCache ()	// private
+
+- (NSString*)keyForURN:(NSString*)urn days:(NSInteger)days;
+- (NSNumber*)stampForLoadDate:(NSDate*)loadDate;
+- (NSString*)fileKeyForURN:(NSString*)urn stamp:(NSNumber*)stamp days:(NSInteger)days;
+- (NSString*)pathForKey:(NSString*)key;
+- (NSArray*)percentagesForChart:(Chart*)chart days:(NSInteger)days;
+- (void)objectsDidChangeNotification:(NSNotification*)notification;
+- (void)generateMissingSparklinesForPlace:(Place*)place;
+- (void)cacheImage:(UIImage*)image forKey:(NSString*)key;
+- (void)didReceiveMemoryWarning:(NSNotification*)notification;
+
+// Run on the queue
+- (void)loadSparkline:(NSDictionary*)job;
+- (void)drawSparkline:(NSDictionary*)job;
+- (NSData*)PNGDataForImage:(CGImageRef)imageRef;
+- (void)indexDiskCache;
+- (void)addDiskFile:(NSString*)name size:(unsigned long long)size;
+- (void)trimDiskCache;
+- (void)writeLoadDates:(NSDictionary*)loadDates;
+
+// Run on the main thread
+- (void)didLoadSparkline:(NSDictionary*)result;
+
+@end
+
+
+@implementation SparklineCache
+
+@synthesize maxDiskBytes = _maxDiskBytes;
+
+
++ (SparklineCache*)sharedCache
+{
+	static SparklineCache* cache = nil;
+	
+	if (cache == nil) {
+		cache = [[SparklineCache alloc] init];
+	}
+	return cache;
+}
+
++ (CGSize)sparklineSize
+{
+	return CGSizeMake(kSparklineWidth, kSparklineHeight);
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[NSObject cancelPreviousPerformRequestsWithTarget:self];
+	[_queue cancelAllOperations];
+	[_queue release];
+	[_images release];
+	[_recentKeys release];
+	[_loadDates release];
+	[_pendingKeys release];
+	[_missingKeys release];
+	[_directory release];
+	[_loadDatesPath release];
+	[_diskNames release];
+	[_diskSizes release];
+	[super dealloc];
+}
+
+- (id)init
+{
+	assert([NSThread isMainThread]);
+	if ((self = [super init])) {
+		_queue = [[NSOperationQueue alloc] init];
+		// One operation at a time keeps the disk cache consistent while trimming
+		[_queue setMaxConcurrentOperationCount:1];
+		_images = [[NSMutableDictionary alloc] init];
+		_recentKeys = [[NSMutableArray alloc] init];
+		_pendingKeys = [[NSMutableSet alloc] init];
+		_missingKeys = [[NSMutableSet alloc] init];
+		_maxDiskBytes = kDefaultMaxDiskBytes;
+		_diskNames = [[NSMutableArray alloc] init];
+		_diskSizes = [[NSMutableDictionary alloc] init];
+		
+		NSString* caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) lastObject];
+		_directory = [[caches stringByAppendingPathComponent:@"Sparklines"] retain];
+		NSError* error = nil;
+		if (![[NSFileManager defaultManager] fileExistsAtPath:_directory]
+			&& ![[NSFileManager defaultManager] createDirectoryAtPath:_directory withIntermediateDirectories:YES attributes:nil error:&error]) {
+			NSLog(@"Could not create sparkline cache directory: %@", error);
+		}
+		// Outside the directory, so that trimming never removes it
+		_loadDatesPath = [[caches stringByAppendingPathComponent:@"SparklineLoadDates.plist"] retain];
+		_loadDates = [[NSMutableDictionary alloc] initWithContentsOfFile:_loadDatesPath];
+		if (!_loadDates) {
+			_loadDates = [[NSMutableDictionary alloc] init];
+		}
+		
+		[[NSNotificationCenter defaultCenter] addObserver:self
+												 selector:@selector(objectsDidChangeNotification:)
+													 name:NSManagedObjectContextObjectsDidChangeNotification
+												   object:[[DataManager manager] rootContext]];
+		[[NSNotificationCenter defaultCenter] addObserver:self
+												 selector:@selector(didReceiveMemoryWarning:)
+													 name:UIApplicationDidReceiveMemoryWarningNotification
+												   object:nil];
+	}
+	return self;
+}
+
+- (NSString*)keyForURN:(NSString*)urn days:(NSInteger)days
+{
+	return [NSString stringWithFormat:@"%@-%d", urn, (int)days];
+}
+
+// Whole seconds, which survive the property list unchanged
+- (NSNumber*)stampForLoadDate:(NSDate*)loadDate
+{
+	return [NSNumber numberWithLongLong:llround([loadDate timeIntervalSinceReferenceDate])];
+}
+
+- (NSString*)fileKeyForURN:(NSString*)urn stamp:(NSNumber*)stamp days:(NSInteger)days
+{
+	NSString* name = [[urn stringByReplacingOccurrencesOfString:@"/" withString:@"_"]
+					  stringByReplacingOccurrencesOfString:@":" withString:@"_"];
+	return [NSString stringWithFormat:@"%@-%lld-%d", name, [stamp longLongValue], (int)days];
+}
+
+- (NSString*)pathForKey:(NSString*)key
+{
+	return [_directory stringByAppendingPathComponent:[key stringByAppendingPathExtension:@"png"]];
+}
+
+- (UIImage*)sparklineForPlace:(Place*)place days:(NSInteger)days
+{
+	assert([NSThread isMainThread]);
+	
+	NSString* urn = place.urn;
+	if (!urn) {
+		return nil;
+	}
+	NSString* key = [self keyForURN:urn days:days];
+	UIImage* image = [_images objectForKey:key];
+	if (image) {
+		// At most kMaxImagesInMemory keys, so moving one to the recent end is cheap
+		[_recentKeys removeObject:key];
+		[_recentKeys addObject:key];
+		return image;
+	}
+	
+	NSNumber* stamp = [_loadDates objectForKey:urn];
+	if (!stamp) {
+		// Charts imported before their load dates were recorded, or places without a chart:
+		// look once, after the table stops tracking touches
+		if (![_missingKeys containsObject:urn]) {
+			[_missingKeys addObject:urn];
+			[self performSelector:@selector(generateMissingSparklinesForPlace:)
+					   withObject:place
+					   afterDelay:0.0
+						  inModes:[NSArray arrayWithObject:NSDefaultRunLoopMode]];
+		}
+		return nil;
+	}
+	NSString* fileKey = [self fileKeyForURN:urn stamp:stamp days:days];
+	if (![_pendingKeys containsObject:fileKey]) {
+		[_pendingKeys addObject:fileKey];
+		NSDictionary* job = [NSDictionary dictionaryWithObjectsAndKeys:
+							 key, @"key",
+							 fileKey, @"fileKey",
+							 urn, @"urn",
+							 stamp, @"stamp",
+							 [place objectID], @"placeID",
+							 nil];
+		NSInvocationOperation* operation = [[NSInvocationOperation alloc] initWithTarget:self
+																				selector:@selector(loadSparkline:)
+																				  object:job];
+		[_queue addOperation:operation];
+		[operation release];
+	}
+	return nil;
+}
+
+- (void)generateMissingSparklinesForPlace:(Place*)place
+{
+	if (place.chart && ![place isDeleted]) {
+		[self generateSparklinesForChart:place.chart];
+	}
+}
+
+- (void)cacheImage:(UIImage*)image forKey:(NSString*)key
+{
+	if ([_images objectForKey:key]) {
+		[_recentKeys removeObject:key];
+	} else if ([_recentKeys count] >= kMaxImagesInMemory) {
+		[_images removeObjectForKey:[_recentKeys objectAtIndex:0]];
+		[_recentKeys removeObjectAtIndex:0];
+	}
+	[_images setObject:image forKey:key];
+	[_recentKeys addObject:key];
+}
+
+- (void)objectsDidChangeNotification:(NSNotification*)notification
+{
+	for (NSManagedObject* object in [[notification userInfo] objectForKey:NSInsertedObjectsKey]) {
+		if ([object isKindOfClass:[Chart class]]) {
+			// Let the merge complete before reading the series
+			[self performSelector:@selector(generateSparklinesForChart:) withObject:object afterDelay:0.0];
+		}
+	}
+}
+
+- (NSArray*)percentagesForChart:(Chart*)chart days:(NSInteger)days
+{
+	NSCalendar* gregorian = [NSCalendar gregorian];
+	NSInteger year = [[gregorian components:NSYearCalendarUnit fromDate:chart.xEnd] year];
+	int day = [gregorian ordinalityOfUnit:NSDayCalendarUnit inUnit:NSYearCalendarUnit forDate:chart.xEnd];
+	// Series stack non-leap years on leap years, see ChartValue
+	if (day > 31 + 28 && ![NSCalendar isLeapYear:year]) {
+		day++;
+	}
+	
+	NSMutableDictionary* seriesByYear = [NSMutableDictionary dictionaryWithCapacity:[chart.series count]];
+	for (ChartSeries* series in chart.series) {
+		[seriesByYear setObject:series forKey:series.year];
+	}
+	
+	NSNumber* gap = [NSNumber numberWithFloat:NAN];
+	NSMutableArray* percentages = [NSMutableArray arrayWithCapacity:days];
+	ChartSeries* series = [seriesByYear objectForKey:[NSNumber numberWithInt:year]];
+	for (NSInteger i = 0; i < days; i++) {
+		ChartValue* value = [series getValueForDayInYear:day];
+		[percentages addObject:value ? [NSNumber numberWithFloat:value.percentage] : gap];
+		if (--day < 1) {
+			day = 366;
+			series = [seriesByYear objectForKey:[NSNumber numberWithInt:--year]];
+		}
+	}
+	return [[percentages reverseObjectEnumerator] allObjects];
+}
+
+- (void)generateSparklinesForChart:(Chart*)chart
+{
+	assert([NSThread isMainThread]);
+	
+	NSString* urn = chart.place.urn;
+	if ([chart isDeleted] || !urn || !chart.loadDate || !chart.xEnd) {
+		return;
+	}
+	// A reloaded chart replaces the images in memory once they are drawn
+	NSNumber* stamp = [self stampForLoadDate:chart.loadDate];
+	BOOL reloaded = ![stamp isEqual:[_loadDates objectForKey:urn]];
+	if (reloaded) {
+		[_loadDates setObject:stamp forKey:urn];
+		NSInvocationOperation* operation = [[NSInvocationOperation alloc] initWithTarget:self
+																				selector:@selector(writeLoadDates:)
+																				  object:[[_loadDates copy] autorelease]];
+		[_queue addOperation:operation];
+		[operation release];
+	}
+	
+	BOOL drawing = NO;
+	NSInteger spans[] = { kSparklineDaysMonth, kSparklineDaysQuarter, kSparklineDaysYear };
+	for (size_t i = 0; i < sizeof(spans) / sizeof(spans[0]); i++) {
+		NSString* key = [self keyForURN:urn days:spans[i]];
+		NSString* fileKey = [self fileKeyForURN:urn stamp:stamp days:spans[i]];
+		if ((!reloaded && [_images objectForKey:key]) || [_pendingKeys containsObject:fileKey]) {
+			continue;
+		}
+		[_pendingKeys addObject:fileKey];
+		NSDictionary* job = [NSDictionary dictionaryWithObjectsAndKeys:
+							 key, @"key",
+							 fileKey, @"fileKey",
+							 urn, @"urn",
+							 stamp, @"stamp",
+							 [self percentagesForChart:chart days:spans[i]], @"percentages",
+							 nil];
+		NSInvocationOperation* operation = [[NSInvocationOperation alloc] initWithTarget:self
+																				selector:@selector(drawSparkline:)
+																				  object:job];
+		[_queue addOperation:operation];
+		[operation release];
+		drawing = YES;
+	}
+	if (drawing) {
+		// Reading the percentages faulted in the chart's data, which nobody may be looking at
+		[[ChartBudget sharedBudget] trimToBudget];
+	}
+}
+
+- (void)loadSparkline:(NSDictionary*)job
+{
+	NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+	NSData* data = [NSData dataWithContentsOfFile:[self pathForKey:[job objectForKey:@"fileKey"]]];
+	NSMutableDictionary* result = [[job mutableCopy] autorelease];
+	if (data) {
+		[result setObject:data forKey:@"data"];
+	}
+	[self performSelectorOnMainThread:@selector(didLoadSparkline:) withObject:result waitUntilDone:NO];
+	[pool release];
+}
+
+- (void)drawSparkline:(NSDictionary*)job
+{
+	NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+	
+	UIScreen* screen = [UIScreen mainScreen];
+	CGFloat scale = [screen respondsToSelector:@selector(scale)] ? [screen scale] : 1.0f;
+	size_t width = (size_t)(kSparklineWidth * scale);
+	size_t height = (size_t)(kSparklineHeight * scale);
+	
+	CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+	CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace, kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+	CGColorSpaceRelease(colorSpace);
+	if (!context) {
+		NSLog(@"Could not create sparkline bitmap context");
+		[pool release];
+		return;
+	}
+	CGContextScaleCTM(context, scale, scale);
+	
+	// Percentages run from 0 to 1, leave room for the line width at the edges
+	NSArray* percentages = [job objectForKey:@"percentages"];
+	CGFloat inset = 2.0f;
+	CGFloat dx = [percentages count] > 1 ? kSparklineWidth / ([percentages count] - 1) : 0.0f;
+	CGFloat dy = kSparklineHeight - 2.0f * inset;
+	CGMutablePathRef line = CGPathCreateMutable();
+	CGMutablePathRef fill = CGPathCreateMutable();
+	BOOL inSegment = NO;
+	CGFloat segmentStart = 0.0f;
+	CGFloat x = 0.0f;
+	for (NSUInteger i = 0; i < [percentages count]; i++, x += dx) {
+		float percentage = [[percentages objectAtIndex:i] floatValue];
+		if (isnan(percentage)) {
+			if (inSegment) {
+				CGPathAddLineToPoint(fill, NULL, x - dx, 0.0f);
+				CGPathAddLineToPoint(fill, NULL, segmentStart, 0.0f);
+				CGPathCloseSubpath(fill);
+			}
+			inSegment = NO;
+			continue;
+		}
+		CGFloat y = inset + dy * MIN(MAX(percentage, 0.0f), 1.0f);
+		if (inSegment) {
+			CGPathAddLineToPoint(line, NULL, x, y);
+			CGPathAddLineToPoint(fill, NULL, x, y);
+		} else {
+			CGPathMoveToPoint(line, NULL, x, y);
+			CGPathMoveToPoint(fill, NULL, x, 0.0f);
+			CGPathAddLineToPoint(fill, NULL, x, y);
+			segmentStart = x;
+			inSegment = YES;
+		}
+	}
+	if (inSegment) {
+		CGPathAddLineToPoint(fill, NULL, x - dx, 0.0f);
+		CGPathAddLineToPoint(fill, NULL, segmentStart, 0.0f);
+		CGPathCloseSubpath(fill);
+	}
+	
+	CGContextSetRGBFillColor(context, 0.0f, 121.0f/255.0f, 205.0f/255.0f, 0.15f);
+	CGContextAddPath(context, fill);
+	CGContextFillPath(context);
+	CGContextSetRGBStrokeColor(context, 0.0f, 121.0f/255.0f, 205.0f/255.0f, 0.5f);
+	CGContextSetLineWidth(context, 1.5f);
+	CGContextSetLineJoin(context, kCGLineJoinRound);
+	CGContextAddPath(context, line);
+	CGContextStrokePath(context);
+	CGPathRelease(line);
+	CGPathRelease(fill);
+	
+	CGImageRef imageRef = CGBitmapContextCreateImage(context);
+	CGContextRelease(context);
+	NSData* data = [self PNGDataForImage:imageRef];
+	
+	NSString* fileKey = [job objectForKey:@"fileKey"];
+	NSMutableDictionary* result = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+								   [job objectForKey:@"key"], @"key",
+								   fileKey, @"fileKey",
+								   [job objectForKey:@"urn"], @"urn",
+								   [job objectForKey:@"stamp"], @"stamp",
+								   nil];
+	if (data) {
+		NSString* path = [self pathForKey:fileKey];
+		if ([data writeToFile:path atomically:YES]) {
+			[self addDiskFile:[path lastPathComponent] size:[data length]];
+			[self trimDiskCache];
+		} else {
+			NSLog(@"Could not write sparkline %@", fileKey);
+		}
+		[result setObject:data forKey:@"data"];
+	} else if (imageRef) {
+		// Not encoded, keep it in memory only
+		[result setObject:(id)imageRef forKey:@"image"];
+	}
+	CGImageRelease(imageRef);
+	
+	[self performSelectorOnMainThread:@selector(didLoadSparkline:) withObject:result waitUntilDone:NO];
+	[pool release];
+}
+
+- (NSData*)PNGDataForImage:(CGImageRef)imageRef
+{
+	// UIImagePNGRepresentation is main-thread only; ImageIO is not, but is weakly linked
+	// since it needs iOS 4
+	if (!imageRef || CGImageDestinationCreateWithData == NULL) {
+		return nil;
+	}
+	NSMutableData* data = [NSMutableData data];
+	CGImageDestinationRef destination = CGImageDestinationCreateWithData((CFMutableDataRef)data, CFSTR("public.png"), 1, NULL);
+	if (!destination) {
+		NSLog(@"Could not create sparkline image destination");
+		return nil;
+	}
+	CGImageDestinationAddImage(destination, imageRef, NULL);
+	BOOL encoded = CGImageDestinationFinalize(destination);
+	CFRelease(destination);
+	if (!encoded) {
+		NSLog(@"Could not encode sparkline");
+		return nil;
+	}
+	return data;
+}
+
+// Reads the sizes and ages of the files already on disk, once. Files written afterwards are
+// added by addDiskFile:size:, so a write never enumerates the directory.
+- (void)indexDiskCache
+{
+	if (_diskIndexed) {
+		return;
+	}
+	_diskIndexed = YES;
+	[_diskNames removeAllObjects];
+	[_diskSizes removeAllObjects];
+	_diskBytes = 0;
+	
+	NSFileManager* fileManager = [[[NSFileManager alloc] init] autorelease];
+	NSArray* names = [fileManager contentsOfDirectoryAtPath:_directory error:NULL];
+	NSMutableArray* files = [NSMutableArray arrayWithCapacity:[names count]];
+	for (NSString* name in names) {
+		NSDictionary* attributes = [fileManager attributesOfItemAtPath:[_directory stringByAppendingPathComponent:name] error:NULL];
+		if (attributes) {
+			[files addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+							  name, @"name",
+							  [attributes fileModificationDate], @"date",
+							  [NSNumber numberWithUnsignedLongLong:[attributes fileSize]], @"size",
+							  nil]];
+		}
+	}
+	[files sortUsingDescriptors:[NSArray arrayWithObject:[[[NSSortDescriptor alloc] initWithKey:@"date" ascending:YES] autorelease]]];
+	for (NSDictionary* file in files) {
+		NSString* name = [file objectForKey:@"name"];
+		NSNumber* size = [file objectForKey:@"size"];
+		[_diskNames addObject:name];
+		[_diskSizes setObject:size forKey:name];
+		_diskBytes += [size unsignedLongLongValue];
+	}
+}
+
+- (void)addDiskFile:(NSString*)name size:(unsigned long long)size
+{
+	[self indexDiskCache];
+	NSNumber* previousSize = [_diskSizes objectForKey:name];
+	if (previousSize) {
+		// Only a sparkline drawn again after it went missing is rewritten
+		_diskBytes -= [previousSize unsignedLongLongValue];
+		[_diskNames removeObject:name];
+	}
+	[_diskNames addObject:name];
+	[_diskSizes setObject:[NSNumber numberWithUnsignedLongLong:size] forKey:name];
+	_diskBytes += size;
+}
+
+- (void)trimDiskCache
+{
+	[self indexDiskCache];
+	NSFileManager* fileManager = [[[NSFileManager alloc] init] autorelease];
+	while (_diskBytes > _maxDiskBytes && [_diskNames count] > 0) {
+		NSString* name = [[[_diskNames objectAtIndex:0] retain] autorelease];
+		if (![fileManager removeItemAtPath:[_directory stringByAppendingPathComponent:name] error:NULL]) {
+			NSLog(@"Could not remove sparkline %@", name);
+		}
+		// Forgotten even if it could not be removed, so that it is not retried on every write
+		_diskBytes -= [[_diskSizes objectForKey:name] unsignedLongLongValue];
+		[_diskSizes removeObjectForKey:name];
+		[_diskNames removeObjectAtIndex:0];
+	}
+}
+
+- (void)writeLoadDates:(NSDictionary*)loadDates
+{
+	NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+	if (![loadDates writeToFile:_loadDatesPath atomically:YES]) {
+		NSLog(@"Could not write sparkline load dates");
+	}
+	[pool release];
+}
+
+- (void)didLoadSparkline:(NSDictionary*)result
+{
+	NSString* key = [result objectForKey:@"key"];
+	NSString* urn = [result objectForKey:@"urn"];
+	NSData* data = [result objectForKey:@"data"];
+	[_pendingKeys removeObject:[result objectForKey:@"fileKey"]];
+	if (![[result objectForKey:@"stamp"] isEqual:[_loadDates objectForKey:urn]]) {
+		// The chart was reloaded meanwhile
+		return;
+	}
+	
+	UIImage* image = data ? [UIImage imageWithData:data] : nil;
+	if (!image && [result objectForKey:@"image"]) {
+		image = [UIImage imageWithCGImage:(CGImageRef)[result objectForKey:@"image"]];
+	}
+	if (!image) {
+		// Trimmed from disk: draw them once, after the table stops tracking touches
+		NSManagedObjectID* placeID = [result objectForKey:@"placeID"];
+		if (placeID && ![_missingKeys containsObject:urn]) {
+			[_missingKeys addObject:urn];
+			Place* place = (Place*)[[[DataManager manager] rootContext] objectWithID:placeID];
+			[self performSelector:@selector(generateMissingSparklinesForPlace:)
+					   withObject:place
+					   afterDelay:0.0
+						  inModes:[NSArray arrayWithObject:NSDefaultRunLoopMode]];
+		}
+		return;
+	}
+	[self cacheImage:image forKey:key];
+	[[NSNotificationCenter defaultCenter] postNotificationName:kSparklineAvailableNotification object:urn];
+}
+
+- (void)didReceiveMemoryWarning:(NSNotification*)notification
+{
+	[_images removeAllObjects];
+	[_recentKeys removeAllObjects];
+}
+
+- (void)removeAllSparklines
+{
+	assert([NSThread isMainThread]);
+	[_queue cancelAllOperations];
+	[_queue waitUntilAllOperationsAreFinished];
+	[_images removeAllObjects];
+	[_recentKeys removeAllObjects];
+	[_loadDates removeAllObjects];
+	[_pendingKeys removeAllObjects];
+	[_missingKeys removeAllObjects];
+	NSFileManager* fileManager = [NSFileManager defaultManager];
+	[fileManager removeItemAtPath:_loadDatesPath error:NULL];
+	for (NSString* name in [fileManager contentsOfDirectoryAtPath:_directory error:NULL]) {
+		[fileManager removeItemAtPath:[_directory stringByAppendingPathComponent:name] error:NULL];
+	}
+	// The queue is idle, so the next write can read the index from disk again
+	_diskIndexed = NO;
+}
+
+@end
@@ -47,6 +47,7 @@
 #import "CPSlateTheme.h"
 #import "CPStocksTheme.h"
 #import "CPTextLayer.h"
+#import "CPTextLayoutCache.h"
 #import "CPTextStyle.h"
 #import "CPTheme.h"
 #import "CPTimeFormatter.h"
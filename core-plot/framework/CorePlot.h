@@ -45,6 +45,7 @@
 #import <CorePlot/CPSlateTheme.h>
 #import <CorePlot/CPStocksTheme.h>
 #import <CorePlot/CPTextLayer.h>
+#import <CorePlot/CPTextLayoutCache.h>
 #import <CorePlot/CPTextStyle.h>
 #import <CorePlot/CPTradingRangePlot.h>
 #import <CorePlot/CPTheme.h>
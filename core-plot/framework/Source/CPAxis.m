@@ -25,6 +25,7 @@
 
 -(void)tickLocationsBeginningAt:(NSDecimal)beginNumber increasing:(BOOL)increasing majorTickLocations:(NSSet **)newMajorLocations minorTickLocations:(NSSet **)newMinorLocations;
 -(NSDecimal)nextLocationFromCoordinateValue:(NSDecimal)coord increasing:(BOOL)increasing interval:(NSDecimal)interval;
+-(void)doublePrecisionTickLocationsBeginningAt:(double)beginNumber increasing:(BOOL)increasing majorTickLocations:(NSSet **)newMajorLocations minorTickLocations:(NSSet **)newMinorLocations;
 -(NSSet *)filteredTickLocations:(NSSet *)allLocations;
 -(void)updateAxisLabelsAtLocations:(NSSet *)locations;
 
@@ -361,6 +362,11 @@
 
 -(void)tickLocationsBeginningAt:(NSDecimal)beginNumber increasing:(BOOL)increasing majorTickLocations:(NSSet **)newMajorLocations minorTickLocations:(NSSet **)newMinorLocations
 {
+	if ( self.plotSpace.doublePrecisionArithmetic ) {
+		[self doublePrecisionTickLocationsBeginningAt:CPDecimalDoubleValue(beginNumber) increasing:increasing majorTickLocations:newMajorLocations minorTickLocations:newMinorLocations];
+		return;
+	}
+	
 	NSMutableSet *majorLocations = [NSMutableSet set];
 	NSMutableSet *minorLocations = [NSMutableSet set];
 	NSDecimal majorInterval = self.majorIntervalLength;
@@ -407,6 +413,53 @@
 	*newMinorLocations = minorLocations;
 }
 
+-(void)doublePrecisionTickLocationsBeginningAt:(double)beginNumber increasing:(BOOL)increasing majorTickLocations:(NSSet **)newMajorLocations minorTickLocations:(NSSet **)newMinorLocations
+{
+	NSMutableSet *majorLocations = [NSMutableSet set];
+	NSMutableSet *minorLocations = [NSMutableSet set];
+	double majorInterval = CPDecimalDoubleValue(self.majorIntervalLength);
+	CPPlotRange *range = [[self.plotSpace plotRangeForCoordinate:self.coordinate] copy];
+    if ( self.visibleRange ) {
+        [range intersectionPlotRange:self.visibleRange];
+    }
+	
+	if ( majorInterval > 0.0 ) {
+		// Step by multiplying rather than accumulating so rounding errors do not build up
+		double direction = ( increasing ? 1.0 : -1.0 );
+		NSUInteger minorTicksPerInterval = self.minorTicksPerInterval;
+		double minorInterval = majorInterval / (minorTicksPerInterval + 1);
+		double coord = beginNumber;
+		for ( NSUInteger majorTickIndex = 1;
+			  range && ((increasing && coord <= range.endDouble) || (!increasing && coord >= range.locationDouble));
+			  majorTickIndex++ ) {
+			
+			// Major tick
+			if ( [range containsDouble:coord] ) {
+				[majorLocations addObject:[NSDecimalNumber decimalNumberWithDecimal:CPDecimalFromDouble(coord)]];
+			}
+			
+			// Minor ticks
+			for ( NSUInteger minorTickIndex = 1; minorTickIndex <= minorTicksPerInterval; minorTickIndex++ ) {
+				double minorCoord = coord + direction * minorTickIndex * minorInterval;
+				if ( [range containsDouble:minorCoord] ) {
+					[minorLocations addObject:[NSDecimalNumber decimalNumberWithDecimal:CPDecimalFromDouble(minorCoord)]];
+				}
+			}
+			
+			coord = beginNumber + direction * majorTickIndex * majorInterval;
+		}
+	}
+	else {
+		if ( [range containsDouble:beginNumber] ) {
+			[majorLocations addObject:[NSDecimalNumber decimalNumberWithDecimal:CPDecimalFromDouble(beginNumber)]];
+		}		
+	}
+	
+	[range release];
+	*newMajorLocations = majorLocations;
+	*newMinorLocations = minorLocations;
+}
+
 
 -(void)autoGenerateMajorTickLocations:(NSSet **)newMajorLocations minorTickLocations:(NSSet **)newMinorLocations 
 {
@@ -592,10 +645,28 @@
 	CPAxisLabel *blankLabel = [[CPAxisLabel alloc] initWithText:nil textStyle:nil];
 	CPAxisLabelGroup *axisLabelGroup = self.plotArea.axisLabelGroup;
 	CALayer *lastLayer = nil;
+	
+	// collect the text layers of labels whose ticks went away so new ticks can reuse them
+	NSMutableSet *departingAxisLabels = [self.axisLabels mutableCopy];
+	for ( NSDecimalNumber *tickLocation in locations ) {
+		blankLabel.tickLocation = [tickLocation decimalValue];
+		[departingAxisLabels removeObject:blankLabel];
+	}
+	NSMutableArray *reusableLabelLayers = [[NSMutableArray alloc] initWithCapacity:departingAxisLabels.count];
+	for ( CPAxisLabel *label in departingAxisLabels ) {
+		if ( [label.contentLayer isKindOfClass:[CPTextLayer class]] ) {
+			[reusableLabelLayers addObject:label.contentLayer];
+		}
+		else {
+			[label.contentLayer removeFromSuperlayer];
+		}
+	}
+	[departingAxisLabels release];
 
 	for ( NSDecimalNumber *tickLocation in locations ) {
 		CPAxisLabel *newAxisLabel;
-		BOOL needsNewContentLayer = NO;
+		CPTextLayer *labelLayer = nil;
+		BOOL needsLabelText = NO;
 		
 		// reuse axis labels where possible--will prevent flicker when updating layers
 		blankLabel.tickLocation = [tickLocation decimalValue];
@@ -603,33 +674,52 @@
 		
 		if ( oldAxisLabel ) {
 			newAxisLabel = [oldAxisLabel retain];
+			if ( self.labelFormatterChanged ) {
+				needsLabelText = YES;
+				if ( [oldAxisLabel.contentLayer isKindOfClass:[CPTextLayer class]] ) {
+					labelLayer = [(CPTextLayer *)oldAxisLabel.contentLayer retain];
+				}
+				else {
+					[oldAxisLabel.contentLayer removeFromSuperlayer];
+				}
+			}
 		}
 		else {
-			newAxisLabel = [[CPAxisLabel alloc] initWithText:nil textStyle:nil];
+			if ( reusableLabelLayers.count > 0 ) {
+				labelLayer = [[reusableLabelLayers lastObject] retain];
+				[reusableLabelLayers removeLastObject];
+			}
+			else {
+				labelLayer = [[CPTextLayer alloc] initWithText:nil style:self.labelTextStyle];
+			}
+			newAxisLabel = [[CPAxisLabel alloc] initWithContentLayer:labelLayer];
 			newAxisLabel.tickLocation = [tickLocation decimalValue];
-			needsNewContentLayer = YES;
+			needsLabelText = YES;
 		}
 		
 		newAxisLabel.rotation = self.labelRotation;
 		newAxisLabel.offset = offset;
 		
-		if ( needsNewContentLayer || self.labelFormatterChanged ) {
-			NSString *labelString = [self.labelFormatter stringForObjectValue:tickLocation];
-			CPTextLayer *newLabelLayer = [[CPTextLayer alloc] initWithText:labelString style:self.labelTextStyle];
-			[oldAxisLabel.contentLayer removeFromSuperlayer];
-			newAxisLabel.contentLayer = newLabelLayer;
+		if ( needsLabelText ) {
+			if ( !labelLayer ) {
+				labelLayer = [[CPTextLayer alloc] initWithText:nil style:self.labelTextStyle];
+			}
+			// setting the same string or style again does not resize or redraw the layer
+			labelLayer.textStyle = self.labelTextStyle;
+			labelLayer.text = [self.labelFormatter stringForObjectValue:tickLocation];
+			newAxisLabel.contentLayer = labelLayer;
 			
 			if ( lastLayer ) {
-				[axisLabelGroup insertSublayer:newLabelLayer below:lastLayer];
+				[axisLabelGroup insertSublayer:labelLayer below:lastLayer];
 			}
 			else {
-				[axisLabelGroup insertSublayer:newLabelLayer atIndex:[self.plotArea sublayerIndexForAxis:self layerType:CPGraphLayerTypeAxisLabels]];
+				[axisLabelGroup insertSublayer:labelLayer atIndex:[self.plotArea sublayerIndexForAxis:self layerType:CPGraphLayerTypeAxisLabels]];
 			}
 			
-			[newLabelLayer release];
 			CGPoint tickBasePoint = [self viewPointForCoordinateDecimalNumber:newAxisLabel.tickLocation];
 			[newAxisLabel positionRelativeToViewPoint:tickBasePoint forCoordinate:CPOrthogonalCoordinate(self.coordinate) inDirection:self.tickDirection];
 		}
+		[labelLayer release];
 
 		lastLayer = newAxisLabel.contentLayer;
 		
@@ -638,13 +728,11 @@
 	}
 	[blankLabel release];
 	
-	// remove old labels that are not needed any more from the layer hierarchy
-	NSMutableSet *oldAxisLabels = [self.axisLabels mutableCopy];
-	[oldAxisLabels minusSet:newAxisLabels];
-	for ( CPAxisLabel *label in oldAxisLabels ) {
-		[label.contentLayer removeFromSuperlayer];
+	// remove layers of old labels that were not reused from the layer hierarchy
+	for ( CALayer *labelLayer in reusableLabelLayers ) {
+		[labelLayer removeFromSuperlayer];
 	}
-	[oldAxisLabels release];
+	[reusableLabelLayers release];
 	
 	// do not use accessor because we've already updated the layer hierarchy
 	[axisLabels release];
@@ -947,15 +1035,15 @@
 
 -(void)setMajorTickLocations:(NSSet *)newLocations 
 {
-    if ( newLocations != majorTickLocations ) {
+    if ( newLocations != majorTickLocations && ![newLocations isEqualToSet:majorTickLocations] ) {
         [majorTickLocations release];
         majorTickLocations = [newLocations retain];
 		[self setNeedsDisplay];
 		if ( self.separateLayers ) {
-			[self.majorGridLines setNeedsDisplay];
+			[self.majorGridLines invalidateRenderedContentsCache];
 		}
 		else {
-			[self.plotArea.majorGridLineGroup setNeedsDisplay];
+			[self.plotArea.majorGridLineGroup invalidateRenderedContentsCache];
 		}
 
         self.needsRelabel = YES;
@@ -964,15 +1052,15 @@
 
 -(void)setMinorTickLocations:(NSSet *)newLocations 
 {
-    if ( newLocations != majorTickLocations ) {
+    if ( newLocations != minorTickLocations && ![newLocations isEqualToSet:minorTickLocations] ) {
         [minorTickLocations release];
         minorTickLocations = [newLocations retain];
 		[self setNeedsDisplay];
 		if ( self.separateLayers ) {
-			[self.minorGridLines setNeedsDisplay];
+			[self.minorGridLines invalidateRenderedContentsCache];
 		}
 		else {
-			[self.plotArea.minorGridLineGroup setNeedsDisplay];
+			[self.plotArea.minorGridLineGroup invalidateRenderedContentsCache];
 		}
 
         self.needsRelabel = YES;
@@ -1074,11 +1162,11 @@
 					[gridLines release];
 				}
 				else {
-					[self.majorGridLines setNeedsDisplay];
+					[self.majorGridLines invalidateRenderedContentsCache];
 				}
 			}
 			else {
-				[self.plotArea.majorGridLineGroup setNeedsDisplay];
+				[self.plotArea.majorGridLineGroup invalidateRenderedContentsCache];
 			}
 		}
 		else {
@@ -1103,11 +1191,11 @@
 					[gridLines release];
 				}
 				else {
-					[self.minorGridLines setNeedsDisplay];
+					[self.minorGridLines invalidateRenderedContentsCache];
 				}
 			}
 			else {
-				[self.plotArea.minorGridLineGroup setNeedsDisplay];
+				[self.plotArea.minorGridLineGroup invalidateRenderedContentsCache];
 			}
 		}
 		else {
@@ -1174,12 +1262,12 @@
         [gridLinesRange release];
         gridLinesRange = [newRange copy];
 		if ( self.separateLayers ) {
-			[self.minorGridLines setNeedsDisplay];
-			[self.majorGridLines setNeedsDisplay];
+			[self.minorGridLines invalidateRenderedContentsCache];
+			[self.majorGridLines invalidateRenderedContentsCache];
 		}
 		else {
-			[self.plotArea.minorGridLineGroup setNeedsDisplay];
-			[self.plotArea.majorGridLineGroup setNeedsDisplay];
+			[self.plotArea.minorGridLineGroup invalidateRenderedContentsCache];
+			[self.plotArea.majorGridLineGroup invalidateRenderedContentsCache];
 		}
     }
 }
@@ -1262,11 +1350,11 @@
 		else {
 			self.minorGridLines	= nil;
 			if ( self.minorGridLineStyle ) {
-				[self.plotArea.minorGridLineGroup setNeedsDisplay];
+				[self.plotArea.minorGridLineGroup invalidateRenderedContentsCache];
 			}
 			self.majorGridLines = nil;
 			if ( self.majorGridLineStyle ) {
-				[self.plotArea.majorGridLineGroup setNeedsDisplay];
+				[self.plotArea.majorGridLineGroup invalidateRenderedContentsCache];
 			}
 		}
 		
@@ -353,6 +353,7 @@ static NSString * const CPBarLengthsBindingContext = @"CPBarLengthsBindingContex
     CPCoordinate dependentCoord = ( self.barsAreHorizontal ? CPCoordinateX : CPCoordinateY );
     NSArray *locations = self.barLocations;
     NSArray *lengths = self.barLengths;
+    CGRect dirtyRect = CGContextGetClipBoundingBox(theContext);
     for (NSUInteger ii = 0; ii < [lengths count]; ii++) {
 		id dependentCoordValue = [lengths objectAtIndex:ii];
         id independentCoordValue = [locations objectAtIndex:ii];
@@ -393,6 +394,11 @@ static NSString * const CPBarLengthsBindingContext = @"CPBarLengthsBindingContex
             tipPoint.x += viewOffset;
         }
         
+        // Skip bars outside the region being redrawn
+        CGFloat barOutset = self.dirtyRectOutset;
+        CGRect barRect = CGRectMake(MIN(basePoint.x, tipPoint.x), MIN(basePoint.y, tipPoint.y), fabs(tipPoint.x - basePoint.x), fabs(tipPoint.y - basePoint.y));
+        if ( !CGRectIntersectsRect(dirtyRect, CGRectInset(barRect, -barOutset, -barOutset)) ) continue;
+        
         // Draw
         [self drawBarInContext:theContext fromBasePoint:&basePoint toTipPoint:&tipPoint recordIndex:ii];
     }   
@@ -470,6 +476,39 @@ static NSString * const CPBarLengthsBindingContext = @"CPBarLengthsBindingContex
 	CGPathRelease(path);
 }
 
+#pragma mark -
+#pragma mark Partial Redrawing
+
+-(void)setNeedsDisplayForRecordIndexRange:(NSRange)indexRange
+{
+	NSArray *locations = self.barLocations;
+	NSUInteger endIndex = MIN(NSMaxRange(indexRange), locations.count);
+	if ( indexRange.location >= endIndex ) {
+		[super setNeedsDisplayForRecordIndexRange:indexRange];
+		return;
+	}
+	
+	double minLocation = INFINITY, maxLocation = -INFINITY;
+	for ( NSUInteger ii = indexRange.location; ii < endIndex; ii++ ) {
+		double location = [[locations objectAtIndex:ii] doubleValue];
+		minLocation = MIN(minLocation, location);
+		maxLocation = MAX(maxLocation, location);
+	}
+	
+	CPPlotRange *changedRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromDouble(minLocation) length:CPDecimalFromDouble(maxLocation - minLocation)];
+	if ( self.barsAreHorizontal ) {
+		[self setNeedsDisplayInXRange:nil yRange:changedRange];
+	}
+	else {
+		[self setNeedsDisplayInXRange:changedRange yRange:nil];
+	}
+}
+
+-(CGFloat)dirtyRectOutset
+{
+	return self.barWidth * (0.5 + fabs(self.barOffset)) + self.lineStyle.lineWidth;
+}
+
 #pragma mark -
 #pragma mark Labels
 
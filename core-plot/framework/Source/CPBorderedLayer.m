@@ -147,7 +147,7 @@
 		}
 		[borderLineStyle release];
 		borderLineStyle = [newLineStyle copy];
-		[self setNeedsDisplay];
+		[self invalidateRenderedContentsCache];
 	}
 }
 
@@ -156,7 +156,7 @@
 	if ( newFill != fill ) {
 		[fill release];
 		fill = [newFill copy];
-		[self setNeedsDisplay];
+		[self invalidateRenderedContentsCache];
 	}
 }
 
@@ -45,6 +45,9 @@ typedef enum _CPGradientType {
 	CGFunctionRef gradientFunction;
 	CGFloat angle;	// angle in degrees
 	CPGradientType gradientType;
+	CGFloat *colorLookupTable;
+	NSMutableDictionary *cachedShadings;
+	BOOL isShared;
 }
 
 @property (assign, readonly) CPGradientBlendingMode blendingMode;
@@ -70,6 +73,8 @@ typedef enum _CPGradientType {
 
 +(CPGradient *)rainbowGradient;
 +(CPGradient *)hydrogenSpectrumGradient;
+
++(CPGradient *)sharedGradient:(CPGradient *)gradient;
 ///	@}
 
 /// @name Modification
@@ -13,10 +13,16 @@
 @property (assign, readwrite) CPGradientBlendingMode blendingMode;
 
 -(void)commonInit;
+-(CPGradient *)newUnsharedCopyWithZone:(NSZone *)zone;
 -(void)addElement:(CPGradientElement*)newElement;
 
 -(CGShadingRef)newAxialGradientInRect:(CGRect)rect;
 -(CGShadingRef)newRadialGradientInRect:(CGRect)rect context:(CGContextRef)context;
+-(void)scaleContext:(CGContextRef)context forRadialGradientInRect:(CGRect)rect;
+-(CGShadingRef)shadingInRect:(CGRect)rect context:(CGContextRef)context;
+-(void)invalidateCachedDrawingData;
+-(void)invalidateCachedShadings;
+-(void)prepareColorLookupTable;
 
 -(CPGradientElement *)elementAtIndex:(NSUInteger)index;
 
@@ -34,6 +40,17 @@ static void inverseChromaticEvaluation(void *info, const CGFloat *in, CGFloat *o
 static void transformRGB_HSV(CGFloat *components);
 static void transformHSV_RGB(CGFloat *components);
 static void resolveHSV(CGFloat *color1, CGFloat *color2);
+static void lookupTableEvaluation(void *info, const CGFloat *in, CGFloat *out);
+
+// Number of precomputed colors used when drawing; intermediate positions are interpolated
+static const NSUInteger CPGradientLookupTableSize = 256;
+// Shadings kept per gradient, one for each rect it is drawn in
+static const NSUInteger CPGradientMaxCachedShadings = 8;
+
+// The shared gradient registry is emptied when it reaches this size
+static const NSUInteger CPGradientMaxSharedGradients = 32;
+
+static NSMutableSet *sharedGradients = nil;
 
 #pragma mark -
 
@@ -58,11 +75,13 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
 
 /** @property angle
  *  @brief The axis angle of an axial gradient, expressed in degrees.
+ *	Shared gradients raise an exception when it is set.
  **/
 @synthesize angle;
 
 /** @property gradientType 
  *  @brief The gradient type.
+ *	Shared gradients raise an exception when it is set.
  **/
 @synthesize gradientType;
 
@@ -86,12 +105,22 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
 {
 	colorspace = [[CPColorSpace genericRGBSpace] retain];
     elementList = NULL;
+	colorLookupTable = NULL;
+	cachedShadings = [[NSMutableDictionary alloc] init];
+	
+	// Drawing always samples the lookup table, which is rebuilt whenever the colors change
+    CGFunctionCallbacks evaluationCallbackInfo = {0 , &lookupTableEvaluation, NULL};
+    static const CGFloat input_value_range   [2] = { 0, 1 };
+    static const CGFloat output_value_ranges [8] = { 0, 1, 0, 1, 0, 1, 0, 1 };
+    gradientFunction = CGFunctionCreate(&colorLookupTable, 1, input_value_range, 4, output_value_ranges, &evaluationCallbackInfo);
 }
 
 -(void)dealloc
 {
 	[colorspace release];
 	CGFunctionRelease(gradientFunction);
+	[self invalidateCachedDrawingData];
+	[cachedShadings release];
 	[self removeAllElements];
     [super dealloc];
 }
@@ -99,11 +128,22 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
 -(void)finalize
 {
 	CGFunctionRelease(gradientFunction);
+	[self invalidateCachedDrawingData];
 	[self removeAllElements];
 	[super finalize];
 }
 
 -(id)copyWithZone:(NSZone *)zone
+{
+	// Shared gradients are immutable, so copies (e.g., by fills and plots) can share their cached drawing data
+	if ( isShared ) {
+		return [self retain];
+	}
+	return [self newUnsharedCopyWithZone:zone];
+}
+
+// A mutable copy, even of a shared gradient
+-(CPGradient *)newUnsharedCopyWithZone:(NSZone *)zone
 {
     CPGradient *copy = [[[self class] allocWithZone:zone] init];
 	
@@ -496,6 +536,38 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
     return [newInstance autorelease];
 }
 
+/** @brief Returns a shared gradient equal to the given one.
+ *
+ *	The first time an equal gradient is requested, a copy of it is registered and returned;
+ *	later requests return that same instance, so its color lookup table and shadings are built once.
+ *	Shared gradients are immutable: setting angle or gradientType raises an exception, and the
+ *	methods returning modified gradients return unshared copies.
+ *	The registry only keeps a limited number of gradients; gradients dropped from it stay immutable.
+ *  @param gradient The gradient to look up.
+ *  @return A shared gradient equal to <code>gradient</code>.
+ **/
++(CPGradient *)sharedGradient:(CPGradient *)gradient
+{
+	if ( !gradient ) return nil;
+	
+	CPGradient *sharedGradient = nil;
+	@synchronized ( [CPGradient class] ) {
+		if ( !sharedGradients ) {
+			sharedGradients = [[NSMutableSet alloc] init];
+		}
+		sharedGradient = [sharedGradients member:gradient];
+		if ( !sharedGradient ) {
+			if ( sharedGradients.count >= CPGradientMaxSharedGradients ) {
+				[sharedGradients removeAllObjects];
+			}
+			sharedGradient = [[gradient newUnsharedCopyWithZone:NULL] autorelease];
+			sharedGradient->isShared = YES;
+			[sharedGradients addObject:sharedGradient];
+		}
+	}
+	return sharedGradient;
+}
+
 /** @brief Creates and returns a new CPGradient instance initialized with a hydrogen spectrum gradient.
  *  @return A new CPGradient instance initialized with a hydrogen spectrum gradient.
  **/
@@ -573,9 +645,74 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
 }
 
 
+#pragma mark -
+#pragma mark Comparison
+
+-(BOOL)isEqual:(id)object
+{
+	if ( self == object ) return YES;
+	if ( ![object isKindOfClass:[CPGradient class]] ) return NO;
+	
+	CPGradient *otherGradient = object;
+	if ( (self.blendingMode != otherGradient.blendingMode) || (self.angle != otherGradient.angle) || (self.gradientType != otherGradient.gradientType) ) {
+		return NO;
+	}
+	
+	CPGradientElement *currentElement = self->elementList;
+	CPGradientElement *otherElement = otherGradient->elementList;
+	while ( currentElement != NULL && otherElement != NULL ) {
+		if ( (currentElement->position != otherElement->position) ||
+			 (currentElement->color.red != otherElement->color.red) ||
+			 (currentElement->color.green != otherElement->color.green) ||
+			 (currentElement->color.blue != otherElement->color.blue) ||
+			 (currentElement->color.alpha != otherElement->color.alpha) ) {
+			return NO;
+		}
+		currentElement = currentElement->nextElement;
+		otherElement = otherElement->nextElement;
+	}
+	
+	return (currentElement == NULL && otherElement == NULL);
+}
+
+-(NSUInteger)hash
+{
+	NSUInteger hashValue = (NSUInteger)self.gradientType * 31 + (NSUInteger)self.blendingMode;
+	hashValue = hashValue * 31 + (NSUInteger)(NSInteger)(self.angle * 1000.0);
+	
+	CPGradientElement *currentElement = elementList;
+	while ( currentElement != NULL ) {
+		hashValue = hashValue * 31 + (NSUInteger)(currentElement->position * 1000.0);
+		hashValue = hashValue * 31 + (NSUInteger)(currentElement->color.red * 255.0);
+		hashValue = hashValue * 31 + (NSUInteger)(currentElement->color.green * 255.0);
+		hashValue = hashValue * 31 + (NSUInteger)(currentElement->color.blue * 255.0);
+		hashValue = hashValue * 31 + (NSUInteger)(currentElement->color.alpha * 255.0);
+		currentElement = currentElement->nextElement;
+	}
+	return hashValue;
+}
+
 #pragma mark -
 #pragma mark Modification
 
+-(void)setAngle:(CGFloat)newAngle
+{
+	if ( isShared ) {
+		[NSException raise:NSInternalInconsistencyException format:@"-[%@ setAngle:]: shared gradients are immutable", [self class]];
+	}
+	angle = newAngle;
+	[self invalidateCachedShadings];
+}
+
+-(void)setGradientType:(CPGradientType)newType
+{
+	if ( isShared ) {
+		[NSException raise:NSInternalInconsistencyException format:@"-[%@ setGradientType:]: shared gradients are immutable", [self class]];
+	}
+	gradientType = newType;
+	[self invalidateCachedShadings];
+}
+
 /** @brief Copies the current gradient and sets a new alpha value.
  *  @param alpha The alpha component (0 ≤ alpha ≤ 1).
  *	@return A copy of the current gradient with the new alpha value.
@@ -608,7 +745,7 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
  **/
 -(CPGradient *)gradientWithBlendingMode:(CPGradientBlendingMode)mode
 {
-    CPGradient *newGradient = [self copy];  
+    CPGradient *newGradient = [self newUnsharedCopyWithZone:NULL];
     newGradient.blendingMode = mode;
     return [newGradient autorelease];
 }
@@ -624,7 +761,7 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
  **/
 -(CPGradient *)addColorStop:(CPColor *)color atPosition:(CGFloat)position
 {
-    CPGradient *newGradient = [self copy];
+    CPGradient *newGradient = [self newUnsharedCopyWithZone:NULL];
     CPGradientElement newGradientElement;
 	
     //put the components of color into the newGradientElement - must make sure it is a RGB color (not Gray or CMYK)
@@ -643,7 +780,7 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
  **/
 -(CPGradient *)removeColorStopAtPosition:(CGFloat)position
 {
-    CPGradient *newGradient = [self copy];
+    CPGradient *newGradient = [self newUnsharedCopyWithZone:NULL];
     CPGradientElement removedElement = [newGradient removeElementAtPosition:position];
 	
     if ( isnan(removedElement.position) ) {
@@ -659,7 +796,7 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
  **/
 -(CPGradient *)removeColorStopAtIndex:(NSUInteger)index
 {
-    CPGradient *newGradient = [self copy];
+    CPGradient *newGradient = [self newUnsharedCopyWithZone:NULL];
     CPGradientElement removedElement = [newGradient removeElementAtIndex:index];
 	
     if ( isnan(removedElement.position) ) {
@@ -762,18 +899,9 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
 	
     CGContextClipToRect(context, *(CGRect *)&rect);
 	
-	switch ( self.gradientType ) {
-		case CPGradientTypeAxial:
-			myCGShading = [self newAxialGradientInRect:rect];
-			break;
-		case CPGradientTypeRadial:
-			myCGShading = [self newRadialGradientInRect:rect context:context];
-			break;
-	}
-	
+	myCGShading = [self shadingInRect:rect context:context];
     CGContextDrawShading(context, myCGShading);
 	
-    CGShadingRelease(myCGShading);
     CGContextRestoreGState(context);
 }
 
@@ -790,18 +918,9 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
 		CGRect bounds = CGContextGetPathBoundingBox(context);
 		CGContextClip(context);
 		
-		switch ( self.gradientType ) {
-			case CPGradientTypeAxial:
-				myCGShading = [self newAxialGradientInRect:bounds];
-				break;
-			case CPGradientTypeRadial:
-				myCGShading = [self newRadialGradientInRect:bounds context:context];
-				break;
-		}
-		
+		myCGShading = [self shadingInRect:bounds context:context];
 		CGContextDrawShading(context, myCGShading);
 		
-		CGShadingRelease(myCGShading);
 		CGContextRestoreGState(context);
 	}
 }
@@ -809,6 +928,74 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
 #pragma mark -
 #pragma mark Private Methods
 
+// Returns a shading owned by the receiver. Shadings are kept by rect, so a gradient shared by
+// fills of different sizes reuses each of them; angle and type changes discard them all.
+-(CGShadingRef)shadingInRect:(CGRect)rect context:(CGContextRef)context
+{
+	[self prepareColorLookupTable];
+	
+	NSValue *key = [NSValue valueWithBytes:&rect objCType:@encode(CGRect)];
+	CGShadingRef shading = (CGShadingRef)[cachedShadings objectForKey:key];
+	if ( shading != NULL ) {
+		if ( self.gradientType == CPGradientTypeRadial ) {
+			[self scaleContext:context forRadialGradientInRect:rect];
+		}
+		return shading;
+	}
+	
+	switch ( self.gradientType ) {
+		case CPGradientTypeAxial:
+			shading = [self newAxialGradientInRect:rect];
+			break;
+		case CPGradientTypeRadial:
+			shading = [self newRadialGradientInRect:rect context:context];
+			break;
+	}
+	if ( shading == NULL ) return NULL;
+	
+	if ( cachedShadings.count >= CPGradientMaxCachedShadings ) {
+		[cachedShadings removeAllObjects];
+	}
+	[cachedShadings setObject:(id)shading forKey:key];
+	CGShadingRelease(shading);
+	
+	return shading;
+}
+
+-(void)prepareColorLookupTable
+{
+	if ( colorLookupTable != NULL ) return;
+	
+	colorLookupTable = malloc(CPGradientLookupTableSize * 4 * sizeof(CGFloat));
+	for ( NSUInteger i = 0; i < CPGradientLookupTableSize; i++ ) {
+		CGFloat position = (CGFloat)i / (CGFloat)(CPGradientLookupTableSize - 1);
+		CGFloat *components = &colorLookupTable[i * 4];
+		switch ( self.blendingMode ) {
+			case CPLinearBlendingMode:
+				linearEvaluation(&elementList, &position, components);
+				break;
+			case CPChromaticBlendingMode:
+				chromaticEvaluation(&elementList, &position, components);
+				break;
+			case CPInverseChromaticBlendingMode:
+				inverseChromaticEvaluation(&elementList, &position, components);
+				break;
+		}
+	}
+}
+
+-(void)invalidateCachedDrawingData
+{
+	free(colorLookupTable);
+	colorLookupTable = NULL;
+	[self invalidateCachedShadings];
+}
+
+-(void)invalidateCachedShadings
+{
+	[cachedShadings removeAllObjects];
+}
+
 -(CGShadingRef)newAxialGradientInRect:(CGRect)rect
 {
     // First Calculate where the beginning and ending points should be
@@ -893,49 +1080,36 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
         endRadius = CGRectGetWidth(rect) / 2.0;
     }
 	
-	CGContextScaleCTM(context, scalex, scaley);
+	[self scaleContext:context forRadialGradientInRect:rect];
 	
     CGShadingRef myCGShading = CGShadingCreateRadial(self.colorspace.cgColorSpace, startPoint, startRadius, endPoint, endRadius, gradientFunction, true, true);
 	
 	return myCGShading;
 }
 
+// Radial shadings are circular; scaling the context stretches them to fill the rect
+-(void)scaleContext:(CGContextRef)context forRadialGradientInRect:(CGRect)rect
+{
+    if ( CGRectGetHeight(rect)>CGRectGetWidth(rect) ) {
+		CGContextScaleCTM(context, CGRectGetWidth(rect)/CGRectGetHeight(rect), 1.0);
+    }
+	else {
+		CGContextScaleCTM(context, 1.0, CGRectGetHeight(rect) / CGRectGetWidth(rect));
+    }
+}
+
 -(void)setBlendingMode:(CPGradientBlendingMode)mode;
 {
     blendingMode = mode;
 	
-    // Choose what blending function to use
-    void *evaluationFunction = NULL;
-    switch ( blendingMode ) {
-        case CPLinearBlendingMode:
-			evaluationFunction = &linearEvaluation;
-			break;
-        case CPChromaticBlendingMode:
-			evaluationFunction = &chromaticEvaluation;
-			break;
-        case CPInverseChromaticBlendingMode:
-			evaluationFunction = &inverseChromaticEvaluation;
-			break;
-    }
-	
-    // replace the current CoreGraphics Function with new one
-    if ( gradientFunction != NULL ) {
-        CGFunctionRelease(gradientFunction);
-	}
-	
-    CGFunctionCallbacks evaluationCallbackInfo = {0 , evaluationFunction, NULL};	// Version, evaluator function, cleanup function
-	
-    static const CGFloat input_value_range   [2] = { 0, 1 };					// range  for the evaluator input
-    static const CGFloat output_value_ranges [8] = { 0, 1, 0, 1, 0, 1, 0, 1 };	// ranges for the evaluator output (4 returned values)
-	
-    gradientFunction = CGFunctionCreate(&elementList,					//the two transition colors
-										1, input_value_range  ,		//number of inputs (just fraction of progression)
-										4, output_value_ranges,		//number of outputs (4 - RGBa)
-										&evaluationCallbackInfo);		//info for using the evaluator function
+	// The lookup table is rebuilt with the new blending function on the next draw
+	[self invalidateCachedDrawingData];
 }
 
 -(void)addElement:(CPGradientElement *)newElement
 {
+	[self invalidateCachedDrawingData];
+	
     if ( elementList == NULL || newElement->position < elementList->position ) {
         CPGradientElement *tmpNext = elementList;
         elementList = malloc(sizeof(CPGradientElement));
@@ -962,6 +1136,8 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
 
 -(CPGradientElement)removeElementAtIndex:(NSUInteger)index
 {
+	[self invalidateCachedDrawingData];
+	
     CPGradientElement removedElement;
 	
     if ( elementList != NULL ) {
@@ -1004,7 +1180,10 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
     return removedElement;
 }
 
--(CPGradientElement)removeElementAtPosition:(CGFloat)position {
+-(CPGradientElement)removeElementAtPosition:(CGFloat)position
+{
+	[self invalidateCachedDrawingData];
+	
     CPGradientElement removedElement;
 	
     if ( elementList != NULL ) {
@@ -1046,6 +1225,8 @@ static void resolveHSV(CGFloat *color1, CGFloat *color2);
 
 -(void)removeAllElements
 {
+	[self invalidateCachedDrawingData];
+	
     while (elementList != NULL) {
         CPGradientElement *elementToRemove = elementList;
         elementList = elementList->nextElement;
@@ -1297,6 +1478,26 @@ void inverseChromaticEvaluation(void *info, const CGFloat *in, CGFloat *out)
     out[2] *= out[3];
 }
 
+// Linearly interpolates the precomputed colors; info points to the lookup table pointer
+void lookupTableEvaluation(void *info, const CGFloat *in, CGFloat *out)
+{
+	CGFloat *lookupTable = *(CGFloat **)info;
+	if ( lookupTable == NULL ) {
+		out[0] = out[1] = out[2] = out[3] = 0.0;
+		return;
+	}
+	
+	CGFloat scaledPosition = MIN(MAX(*in, 0.0), 1.0) * (CGFloat)(CPGradientLookupTableSize - 1);
+	NSUInteger index = MIN((NSUInteger)scaledPosition, CPGradientLookupTableSize - 2);
+	CGFloat fraction = scaledPosition - (CGFloat)index;
+	
+	CGFloat *lowerColor = &lookupTable[index * 4];
+	CGFloat *upperColor = lowerColor + 4;
+	for ( NSUInteger i = 0; i < 4; i++ ) {
+		out[i] = lowerColor[i] + (upperColor[i] - lowerColor[i]) * fraction;
+	}
+}
+
 void transformRGB_HSV(CGFloat *components) //H,S,B -> R,G,B
 {
     CGFloat H = NAN, S, V;
@@ -11,6 +11,8 @@
 #import "CPTheme.h"
 #import "CPLayerAnnotation.h"
 #import "CPTextLayer.h"
+#import "CPGridLines.h"
+#import "CPGridLineGroup.h"
 
 ///	@cond
 @interface CPGraph()
@@ -356,6 +358,17 @@
     [self setNeedsLayout];
     [self.axisSet relabelAxes];
     [[self allPlots] makeObjectsPerformSelector:@selector(setNeedsDisplay)];
+    
+    // Grid lines move with the mapping even when the tick locations are unchanged
+    CPPlotArea *thePlotArea = self.plotAreaFrame.plotArea;
+    [thePlotArea.minorGridLineGroup invalidateRenderedContentsCache];
+    [thePlotArea.majorGridLineGroup invalidateRenderedContentsCache];
+    for ( CPAxis *axis in self.axisSet.axes ) {
+        if ( axis.plotSpace == notif.object ) {
+            [axis.minorGridLines invalidateRenderedContentsCache];
+            [axis.majorGridLines invalidateRenderedContentsCache];
+        }
+    }
 }
 
 #pragma mark -
@@ -57,7 +57,7 @@
 		plotArea = newPlotArea;
 		
 		if ( plotArea ) {
-			[self setNeedsDisplay];
+			[self invalidateRenderedContentsCache];
 		}
 	}	
 }
@@ -44,7 +44,7 @@
 {
     if ( newAxis != axis ) {
         axis = newAxis;
-		[self setNeedsDisplay];		
+		[self invalidateRenderedContentsCache];
 	}
 }
 
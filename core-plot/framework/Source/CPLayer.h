@@ -18,6 +18,9 @@
     __weak CPGraph *graph;
 	CGPathRef outerBorderPath;
 	CGPathRef innerBorderPath;
+	BOOL cachesRenderedContents;
+	CGLayerRef renderedContentsCache;
+	CGRect renderedContentsCacheBounds;
 }
 
 /// @name Graph
@@ -55,6 +58,9 @@
 
 /// @name Drawing
 /// @{
+@property (nonatomic, readwrite, assign) BOOL cachesRenderedContents;
+
+-(void)invalidateRenderedContentsCache;
 -(void)renderAsVectorInContext:(CGContextRef)context;
 -(void)recursivelyRenderInContext:(CGContextRef)context;
 -(void)layoutAndRenderInContext:(CGContextRef)context;
@@ -14,6 +14,7 @@
 @property (nonatomic, readwrite, getter=isRenderingRecursively) BOOL renderingRecursively;
 
 -(void)applyTransform:(CATransform3D)transform toContext:(CGContextRef)context;
+-(void)renderCachedContentsInContext:(CGContextRef)context;
 
 @end
 ///	@endcond
@@ -97,6 +98,17 @@
  **/
 @dynamic sublayersExcludedFromAutomaticLayout;
 
+/** @property cachesRenderedContents
+ *  @brief If YES, the layer content is rendered once into an offscreen bitmap that is reused
+ *	by later display passes until the cache is invalidated.
+ *
+ *	Use this for static content such as backgrounds and grid lines. A plain <code>setNeedsDisplay</code>
+ *	redraws the cached bitmap; call invalidateRenderedContentsCache when the content itself changes.
+ *	The cache is also discarded when the bounds change, in size or origin. Recursive rendering
+ *	into PDF and other vector contexts always draws vectors. Defaults to NO.
+ **/
+@synthesize cachesRenderedContents;
+
 // Private properties
 @synthesize renderingRecursively;
 
@@ -129,6 +141,9 @@
 		renderingRecursively = NO;
 		outerBorderPath = NULL;
 		innerBorderPath = NULL;
+		cachesRenderedContents = NO;
+		renderedContentsCache = NULL;
+		renderedContentsCacheBounds = CGRectNull;
 
 		self.frame = newFrame;
 		self.needsDisplayOnBoundsChange = NO;
@@ -161,6 +176,7 @@
 	[layoutManager release];
 	CGPathRelease(outerBorderPath);
 	CGPathRelease(innerBorderPath);
+	CGLayerRelease(renderedContentsCache);
 
 	[super dealloc];
 }
@@ -169,6 +185,7 @@
 {
 	CGPathRelease(outerBorderPath);
 	CGPathRelease(innerBorderPath);
+	CGLayerRelease(renderedContentsCache);
 	[super finalize];
 }
 
@@ -186,7 +203,46 @@
 
 -(void)drawInContext:(CGContextRef)context
 {
-	[self renderAsVectorInContext:context];
+	if ( self.cachesRenderedContents ) {
+		[self renderCachedContentsInContext:context];
+	}
+	else {
+		[self renderAsVectorInContext:context];
+	}
+}
+
+-(void)renderCachedContentsInContext:(CGContextRef)context
+{
+	CGRect selfBounds = self.bounds;
+	if ( selfBounds.size.width <= 0.0 || selfBounds.size.height <= 0.0 ) return;
+	
+	if ( renderedContentsCache && !CGRectEqualToRect(selfBounds, renderedContentsCacheBounds) ) {
+		CGLayerRelease(renderedContentsCache);
+		renderedContentsCache = NULL;
+	}
+	
+	if ( !renderedContentsCache ) {
+		// Sized in points: the layer takes the device resolution, including the contents scale,
+		// from the context it is created with
+		renderedContentsCache = CGLayerCreateWithContext(context, selfBounds.size, NULL);
+		renderedContentsCacheBounds = selfBounds;
+		CGContextRef cacheContext = CGLayerGetContext(renderedContentsCache);
+		CGContextTranslateCTM(cacheContext, -selfBounds.origin.x, -selfBounds.origin.y);
+		[self renderAsVectorInContext:cacheContext];
+	}
+	
+	CGContextDrawLayerInRect(context, selfBounds, renderedContentsCache);
+}
+
+/**	@brief Discards the cached bitmap of the layer content and marks the layer as needing display.
+ *
+ *	Layers that do not cache their rendered contents are simply marked as needing display.
+ **/
+-(void)invalidateRenderedContentsCache
+{
+	CGLayerRelease(renderedContentsCache);
+	renderedContentsCache = NULL;
+	[self setNeedsDisplay];
 }
 
 /**	@brief Draws layer content into the provided graphics context.
@@ -223,9 +279,17 @@
 	}
 	self.renderingRecursively = NO;
 	
-	// render sublayers
+	// render sublayers, skipping those entirely outside the region being drawn
+	CGRect dirtyRect = CGContextGetClipBoundingBox(context);
+	BOOL canSkipSublayers = CATransform3DIsIdentity(self.sublayerTransform);
     NSArray *sublayersCopy = [[self.sublayers copy] autorelease];
 	for ( CALayer *currentSublayer in sublayersCopy ) {
+		// a layer's own content never extends past its frame, but unmasked sublayers can
+		if ( canSkipSublayers && (currentSublayer.masksToBounds || currentSublayer.sublayers.count == 0) &&
+			 !CGRectIntersectsRect(dirtyRect, currentSublayer.frame) ) {
+			continue;
+		}
+		
 		CGContextSaveGState(context);
 		
 		// Shift origin of context to match starting coordinate of sublayer
@@ -619,13 +683,21 @@ static NSString * const BindingsNotSupportedString = @"Bindings are not supporte
 {
 	if ( newRadius != self.cornerRadius ) {
 		super.cornerRadius = newRadius;
-		[self setNeedsDisplay];
+		[self invalidateRenderedContentsCache];
 		
 		self.outerBorderPath = NULL;
 		self.innerBorderPath = NULL;
 	}
 }
 
+-(void)setCachesRenderedContents:(BOOL)newCachesRenderedContents
+{
+	if ( newCachesRenderedContents != cachesRenderedContents ) {
+		cachesRenderedContents = newCachesRenderedContents;
+		[self invalidateRenderedContentsCache];
+	}
+}
+
 #pragma mark -
 #pragma mark Description
 
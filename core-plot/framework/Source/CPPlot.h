@@ -69,13 +69,19 @@
 
 #pragma mark -
 
+/**	@brief The number of fields the plot data cache can hold. Field enumerators must be smaller than this value.
+ **/
+enum {
+	CPPlotMaxCachedFieldCount = 8
+};
+
 @interface CPPlot : CPLayer {
 	@private
     id <CPPlotDataSource> dataSource;
     id <NSCopying, NSObject> identifier;
     CPPlotSpace *plotSpace;
     BOOL dataNeedsReloading;
-    NSMutableDictionary *cachedData;
+    id cachedFieldData[CPPlotMaxCachedFieldCount];
     NSUInteger cachedDataCount;
     BOOL doublePrecisionCache;
 }
@@ -115,6 +121,15 @@
 /// @{
 -(void)setDataNeedsReloading;
 -(void)reloadData;
+-(void)insertDataAtIndex:(NSUInteger)index numberOfRecords:(NSUInteger)numberOfRecords;
+-(void)appendRecords:(NSUInteger)numberOfRecords;
+///	@}
+
+/// @name Drawing
+/// @{
+-(void)setNeedsDisplayForRecordIndexRange:(NSRange)indexRange;
+-(void)setNeedsDisplayInXRange:(CPPlotRange *)xRange yRange:(CPPlotRange *)yRange;
+-(CGFloat)dirtyRectOutset;
 ///	@}
 
 /// @name Plot Data
@@ -4,6 +4,7 @@
 #import "CPPlotAreaFrame.h"
 #import "CPPlotSpace.h"
 #import "CPPlotRange.h"
+#import "CPExceptions.h"
 #import "NSNumberExtensions.h"
 #import "CPUtilities.h"
 
@@ -11,7 +12,6 @@
 @interface CPPlot()
 
 @property (nonatomic, readwrite, assign) BOOL dataNeedsReloading;
-@property (nonatomic, readwrite, retain) NSMutableDictionary *cachedData;
 
 @property (nonatomic, readwrite, assign) NSUInteger cachedDataCount;
 @property (nonatomic, readwrite, assign) BOOL doublePrecisionCache;
@@ -52,8 +52,6 @@
  **/
 @synthesize dataNeedsReloading;
 
-@synthesize cachedData;
-
 /**	@property cachedDataCount
  *	@brief The number of data points stored in the cache.
  **/
@@ -70,7 +68,9 @@
 -(id)initWithFrame:(CGRect)newFrame
 {
 	if ( self = [super initWithFrame:newFrame] ) {
-		cachedData = nil;
+		for ( NSUInteger i = 0; i < CPPlotMaxCachedFieldCount; i++ ) {
+			cachedFieldData[i] = nil;
+		}
 		cachedDataCount = 0;
 		doublePrecisionCache = NO;
 		dataSource = nil;
@@ -83,7 +83,9 @@
 
 -(void)dealloc
 {
-	[cachedData release];
+	for ( NSUInteger i = 0; i < CPPlotMaxCachedFieldCount; i++ ) {
+		[cachedFieldData[i] release];
+	}
     [identifier release];
     [plotSpace release];
     [super dealloc];
@@ -98,6 +100,65 @@
     [super drawInContext:theContext];
 }
 
+/**	@brief Marks the region showing the given records as needing redrawing.
+ *	The default implementation redraws the whole plot. Subclasses that can map records to
+ *	a smaller region override this method.
+ *	@param indexRange The range of record indexes that changed.
+ **/
+-(void)setNeedsDisplayForRecordIndexRange:(NSRange)indexRange
+{
+	[self setNeedsDisplay];
+}
+
+/**	@brief Marks the region covering the given plot ranges as needing redrawing.
+ *	The region is converted to view coordinates and expanded by -dirtyRectOutset,
+ *	so that strokes and symbols drawn across its edges are redrawn too.
+ *	@param xRange The changed range of x values, or nil for the full width of the plot.
+ *	@param yRange The changed range of y values, or nil for the full height of the plot.
+ **/
+-(void)setNeedsDisplayInXRange:(CPPlotRange *)xRange yRange:(CPPlotRange *)yRange
+{
+	if ( !self.plotSpace || (!xRange && !yRange) ) {
+		[self setNeedsDisplay];
+		return;
+	}
+	
+	double startPlotPoint[2], endPlotPoint[2];
+	startPlotPoint[CPCoordinateX] = (xRange ? xRange.locationDouble : 0.0);
+	startPlotPoint[CPCoordinateY] = (yRange ? yRange.locationDouble : 0.0);
+	endPlotPoint[CPCoordinateX] = (xRange ? xRange.endDouble : 0.0);
+	endPlotPoint[CPCoordinateY] = (yRange ? yRange.endDouble : 0.0);
+	CGPoint startViewPoint = [self convertPoint:[self.plotSpace plotAreaViewPointForDoublePrecisionPlotPoint:startPlotPoint] fromLayer:self.plotArea];
+	CGPoint endViewPoint = [self convertPoint:[self.plotSpace plotAreaViewPointForDoublePrecisionPlotPoint:endPlotPoint] fromLayer:self.plotArea];
+	
+	CGRect bounds = self.bounds;
+	CGRect dirtyRect = CGRectMake(MIN(startViewPoint.x, endViewPoint.x), MIN(startViewPoint.y, endViewPoint.y),
+								  fabs(endViewPoint.x - startViewPoint.x), fabs(endViewPoint.y - startViewPoint.y));
+	if ( !xRange ) {
+		dirtyRect.origin.x = CGRectGetMinX(bounds);
+		dirtyRect.size.width = CGRectGetWidth(bounds);
+	}
+	if ( !yRange ) {
+		dirtyRect.origin.y = CGRectGetMinY(bounds);
+		dirtyRect.size.height = CGRectGetHeight(bounds);
+	}
+	
+	CGFloat outset = [self dirtyRectOutset];
+	dirtyRect = CGRectIntersection(CGRectInset(dirtyRect, -outset, -outset), bounds);
+	if ( !CGRectIsNull(dirtyRect) ) {
+		[self setNeedsDisplayInRect:dirtyRect];
+	}
+}
+
+/**	@brief The distance in view coordinates that the plot draws beyond its data points,
+ *	e.g., half the width of a line or a symbol. Dirty regions are expanded by this amount.
+ *	@return The outset distance. The default is zero.
+ **/
+-(CGFloat)dirtyRectOutset
+{
+	return 0.0;
+}
+
 #pragma mark -
 #pragma mark Layout
 
@@ -151,6 +212,70 @@
     [self setNeedsLayout];
 }
 
+/**	@brief Loads new records from the data source into the cache without reloading the existing ones.
+ *
+ *	Call this after the data source has inserted records, so that
+ *	-numberOfRecordsForPlot: already includes them. The new values are spliced into the cached
+ *	field data in place and only the affected region is redrawn.
+ *
+ *	The cache can only be extended when it holds every record of the data source. When it holds a
+ *	partial range (the data source implements -recordIndexRangeForPlot:plotRange:), when it is stale,
+ *	or when the data source changes the kind of numbers it returns, the plot reloads all data instead.
+ *	@param index The record index of the first new record.
+ *	@param numberOfRecords The number of records inserted.
+ **/
+-(void)insertDataAtIndex:(NSUInteger)index numberOfRecords:(NSUInteger)numberOfRecords
+{
+	if ( numberOfRecords == 0 ) return;
+	
+	NSUInteger oldCount = self.cachedDataCount;
+	BOOL cacheCanBeExtended = ( !self.dataNeedsReloading &&
+								self.dataSource != nil &&
+								![self.dataSource respondsToSelector:@selector(recordIndexRangeForPlot:plotRange:)] &&
+								index <= oldCount &&
+								oldCount + numberOfRecords == [self.dataSource numberOfRecordsForPlot:self] );
+	if ( !cacheCanBeExtended ) {
+		[self setDataNeedsReloading];
+		return;
+	}
+	
+	BOOL wasDoublePrecision = self.doublePrecisionCache;
+	NSRange newRecordRange = NSMakeRange(index, numberOfRecords);
+	
+	for ( NSNumber *field in self.fieldIdentifiers ) {
+		NSUInteger fieldEnum = [field unsignedIntegerValue];
+		id cachedNumbers = [self cachedNumbersForField:fieldEnum];
+		id newNumbers = [self numbersFromDataSourceForField:fieldEnum recordIndexRange:newRecordRange];
+		
+		if ( cachedNumbers == nil || self.doublePrecisionCache != wasDoublePrecision ) {
+			self.doublePrecisionCache = wasDoublePrecision;
+			[self setDataNeedsReloading];
+			return;
+		}
+		
+		if ( wasDoublePrecision ) {
+			[(NSMutableData *)cachedNumbers replaceBytesInRange:NSMakeRange(index * sizeof(double), 0) withBytes:[(NSData *)newNumbers bytes] length:numberOfRecords * sizeof(double)];
+		}
+		else {
+			[(NSMutableArray *)cachedNumbers replaceObjectsInRange:NSMakeRange(index, 0) withObjectsFromArray:newNumbers];
+		}
+	}
+	
+	self.cachedDataCount = oldCount + numberOfRecords;
+	
+	// Records after the insertion point moved, so they need redrawing too
+	[self setNeedsDisplayForRecordIndexRange:NSMakeRange(index, self.cachedDataCount - index)];
+}
+
+/**	@brief Loads records added to the end of the data source into the cache.
+ *	@param numberOfRecords The number of records appended.
+ *	@see -insertDataAtIndex:numberOfRecords:
+ **/
+-(void)appendRecords:(NSUInteger)numberOfRecords
+{
+	[self insertDataAtIndex:self.cachedDataCount numberOfRecords:numberOfRecords];
+}
+
 /**	@brief Gets a range of plot data for the given plot and field.
  *	@param fieldEnum The field index.
  *	@param indexRange The range of the data indexes of interest.
@@ -232,11 +357,16 @@
 #pragma mark Data Caching
 
 /**	@brief Stores an array of numbers in the cache.
+ *	The numbers are copied into a mutable buffer so later insertions can extend it in place.
  *	@param numbers An array of numbers to cache.
  *	@param fieldEnum The field enumerator identifying the field.
  **/
 -(void)cacheNumbers:(id)numbers forField:(NSUInteger)fieldEnum 
 {
+	if ( fieldEnum >= CPPlotMaxCachedFieldCount ) {
+		[NSException raise:CPException format:@"Field enumerator %lu exceeds the plot data cache size", (unsigned long)fieldEnum];
+	}
+	
 	if ( numbers == nil ) {
 		self.cachedDataCount = 0;
 		return;
@@ -247,8 +377,9 @@
 	else {
 		self.cachedDataCount = [(NSData *)numbers length] / sizeof(double);
 	}
-    if ( cachedData == nil ) cachedData = [[NSMutableDictionary alloc] initWithCapacity:5];
-    [cachedData setObject:[[numbers copy] autorelease] forKey:[NSNumber numberWithUnsignedInteger:fieldEnum]];
+    id oldNumbers = cachedFieldData[fieldEnum];
+    cachedFieldData[fieldEnum] = [numbers mutableCopy];
+    [oldNumbers release];
 }
 
 /**	@brief Retrieves an array of numbers from the cache.
@@ -257,7 +388,8 @@
  **/
 -(id)cachedNumbersForField:(NSUInteger)fieldEnum 
 {
-    return [self.cachedData objectForKey:[NSNumber numberWithUnsignedInteger:fieldEnum]];
+    if ( fieldEnum >= CPPlotMaxCachedFieldCount ) return nil;
+    return cachedFieldData[fieldEnum];
 }
 
 #pragma mark -
@@ -30,6 +30,7 @@ typedef enum _CPPlotRangeComparisonResult {
 -(id)initWithLocation:(NSDecimal)loc length:(NSDecimal)len;
 
 -(BOOL)contains:(NSDecimal)number;
+-(BOOL)containsDouble:(double)number;
 -(BOOL)isEqualToRange:(CPPlotRange *)otherRange;
 
 -(void)unionPlotRange:(CPPlotRange *)otherRange;
@@ -41,5 +42,6 @@ typedef enum _CPPlotRangeComparisonResult {
 -(void)expandRangeByFactor:(NSDecimal)factor;
 
 -(CPPlotRangeComparisonResult)compareToNumber:(NSNumber *)number;
+-(CPPlotRangeComparisonResult)compareToDouble:(double)number;
 
 @end
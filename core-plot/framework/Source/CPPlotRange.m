@@ -140,6 +140,15 @@
 	return (CPDecimalGreaterThanOrEqualTo(number, self.location) && CPDecimalLessThanOrEqualTo(number, self.end));
 }
 
+/** @brief Determines whether a given number is inside the range using double-precision arithmetic.
+ *  @param number The number to check.
+ *  @return True if <tt>locationDouble</tt> ≤ <tt>number</tt> ≤ <tt>endDouble</tt>.
+ **/
+-(BOOL)containsDouble:(double)number
+{
+	return (number >= locationDouble && number <= locationDouble + lengthDouble);
+}
+
 /** @brief Determines whether a given range is equal to the range of the receiver.
  *  @param otherRange The range to check.
  *  @return True if the ranges both have the same location and length.
@@ -168,15 +177,24 @@
         }
     }
     else {
-    	double d = [number doubleValue];
-        if ( d < self.locationDouble ) 
-        	result = CPPlotRangeComparisonResultNumberBelowRange;
-        else if ( d > self.endDouble ) 
-        	result = CPPlotRangeComparisonResultNumberAboveRange;
-        else {
-        	result = CPPlotRangeComparisonResultNumberInRange;
-        }
+    	result = [self compareToDouble:[number doubleValue]];
+    }
+    return result;
+}
 
+/** @brief Compares a number to the range using double-precision arithmetic.
+ *  @param number The number to check.
+ *  @return The comparison result.
+ **/
+-(CPPlotRangeComparisonResult)compareToDouble:(double)number
+{
+    CPPlotRangeComparisonResult result;
+    if ( number < locationDouble ) 
+        result = CPPlotRangeComparisonResultNumberBelowRange;
+    else if ( number > locationDouble + lengthDouble ) 
+        result = CPPlotRangeComparisonResultNumberAboveRange;
+    else {
+        result = CPPlotRangeComparisonResultNumberInRange;
     }
     return result;
 }
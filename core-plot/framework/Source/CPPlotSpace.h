@@ -81,10 +81,12 @@ extern NSString * const CPPlotSpaceCoordinateMappingDidChangeNotification;
 	id <NSCopying, NSObject> identifier;
     __weak id <CPPlotSpaceDelegate> delegate;
     BOOL allowsUserInteraction;
+    BOOL doublePrecisionArithmetic;
 }
 
 @property (nonatomic, readwrite, copy) id <NSCopying, NSObject> identifier;
 @property (nonatomic, readwrite, assign) BOOL allowsUserInteraction;
+@property (nonatomic, readwrite, assign) BOOL doublePrecisionArithmetic;
 @property (nonatomic, readwrite, assign) __weak CPGraph *graph;
 @property (nonatomic, readwrite, assign) __weak id <CPPlotSpaceDelegate> delegate;
 
@@ -23,6 +23,13 @@ NSString * const CPPlotSpaceCoordinateMappingDidChangeNotification = @"CPPlotSpa
  **/
 @synthesize allowsUserInteraction;
 
+/**	@property doublePrecisionArithmetic
+ *	@brief If YES, coordinate mapping, range and tick calculations use double-precision arithmetic
+ *	instead of NSDecimal. This is much faster but can lose precision for very large or very
+ *	small plot ranges. Defaults to NO.
+ **/
+@synthesize doublePrecisionArithmetic;
+
 /** @property graph
  *  @brief The graph of the space.
  **/
@@ -41,6 +48,7 @@ NSString * const CPPlotSpaceCoordinateMappingDidChangeNotification = @"CPPlotSpa
 	if ( self = [super init] ) {
 		identifier = nil;
         allowsUserInteraction = NO;
+        doublePrecisionArithmetic = NO;
         graph = nil;
         delegate = nil;
 	}
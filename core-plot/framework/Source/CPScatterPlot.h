@@ -24,6 +24,13 @@ typedef enum _CPScatterPlotField {
     CPScatterPlotFieldY 								///< Y values.
 } CPScatterPlotField;
 
+/**	@brief Enumeration of scatter plot data line decimation methods.
+ **/
+typedef enum _CPScatterPlotDecimation {
+    CPScatterPlotDecimationNone,						///< Every data point is added to the data line.
+    CPScatterPlotDecimationMinMax						///< Only the first, last, minimum and maximum points in each view column are added to the data line.
+} CPScatterPlotDecimation;
+
 /**	@brief A scatter plot data source.
  **/
 @protocol CPScatterPlotDataSource <CPPlotDataSource>
@@ -66,12 +73,18 @@ typedef enum _CPScatterPlotField {
     CPFill *areaFill;
     NSDecimal areaBaseValue;
     NSArray *plotSymbols;
+	CPScatterPlotDecimation decimation;
+	NSMutableData *decimatedPointFlags;
+	CPPlotRange *decimatedXRange;
+	CPPlotRange *decimatedYRange;
+	CGRect decimatedBounds;
 } 
 
 @property (nonatomic, readwrite, copy) CPLineStyle *dataLineStyle;
 @property (nonatomic, readwrite, copy) CPPlotSymbol *plotSymbol;
 @property (nonatomic, readwrite, copy) CPFill *areaFill;
 @property (nonatomic, readwrite) NSDecimal areaBaseValue;
+@property (nonatomic, readwrite, assign) CPScatterPlotDecimation decimation;
 
 -(NSUInteger)indexOfVisiblePointClosestToPlotAreaPoint:(CGPoint)viewPoint;
 -(CGPoint)plotAreaPointOfVisiblePointAtIndex:(NSUInteger)index;
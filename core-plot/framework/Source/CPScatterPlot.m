@@ -40,11 +40,22 @@ static NSString * const CPPlotSymbolsBindingContext = @"CPPlotSymbolsBindingCont
 @property (nonatomic, readonly) double *xDoubleValues;
 @property (nonatomic, readonly) double *yDoubleValues;
 
+@property (nonatomic, readwrite, retain) NSMutableData *decimatedPointFlags;
+@property (nonatomic, readwrite, copy) CPPlotRange *decimatedXRange;
+@property (nonatomic, readwrite, copy) CPPlotRange *decimatedYRange;
+
 -(void)calculatePointsToDraw:(BOOL *)pointDrawFlags forPlotSpace:(CPXYPlotSpace *)plotSpace includeVisiblePointsOnly:(BOOL)visibleOnly;
 -(void)calculateViewPoints:(CGPoint *)viewPoints withDrawPointFlags:(BOOL *)drawPointFlags;
 -(void)alignViewPointsToUserSpace:(CGPoint *)viewPoints withContent:(CGContextRef)theContext drawPointFlags:(BOOL *)drawPointFlags;
 
 -(NSUInteger)extremeDrawnPointIndexForFlags:(BOOL *)pointDrawFlags extremeNumIsLowerBound:(BOOL)isLowerBound;
+-(void)clipFirstDrawnPointIndex:(NSUInteger *)firstIndex lastDrawnPointIndex:(NSUInteger *)lastIndex forViewPoints:(CGPoint *)viewPoints toRect:(CGRect)rect;
+
+-(void)calculateDecimatedPointFlags:(BOOL *)keepPointFlags forViewPoints:(CGPoint *)viewPoints drawPointFlags:(BOOL *)drawPointFlags;
+-(BOOL *)decimatedPointFlagsForViewPoints:(CGPoint *)viewPoints drawPointFlags:(BOOL *)drawPointFlags;
+-(void)invalidateDecimatedPointFlags;
+
+-(void)addSegmentPath:(CGPathRef)segmentPath fromViewPoint:(CGPoint)firstViewPoint toViewPoint:(CGPoint)lastViewPoint toDataLinePath:(CGMutablePathRef)dataLinePath fillPath:(CGMutablePathRef)fillPath baseLineYValue:(CGFloat)baseLineYValue inContext:(CGContextRef)theContext;
 
 CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2);
 
@@ -54,6 +65,10 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2);
 #pragma mark -
 
 /** @brief A two-dimensional scatter plot.
+ *
+ *	A data point with an x or y value that is not a number (NaN) marks a gap in the data.
+ *	The data line and area fill are broken at each gap, so several disjoint segments
+ *	can be drawn by a single plot.
  **/
 @implementation CPScatterPlot
 
@@ -66,6 +81,9 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2);
 @synthesize keyPathForYValues;
 @synthesize keyPathForPlotSymbols;
 @synthesize plotSymbols;
+@synthesize decimatedPointFlags;
+@synthesize decimatedXRange;
+@synthesize decimatedYRange;
 
 /** @property dataLineStyle
  *	@brief The line style for the data line.
@@ -93,6 +111,15 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2);
  **/
 @synthesize areaBaseValue;
 
+/** @property decimation
+ *	@brief The method used to drop data points that do not change the drawn data line.
+ *	Defaults to CPScatterPlotDecimationNone.
+ *
+ *	Decimation only affects the data line and area fill; plot symbols are drawn for every visible point.
+ *	The decimated points are cached until the data, the plot ranges or the bounds change.
+ **/
+@synthesize decimation;
+
 #pragma mark -
 #pragma mark init/dealloc
 
@@ -119,6 +146,11 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2);
 		areaFill = nil;
 		areaBaseValue = [[NSDecimalNumber notANumber] decimalValue];
 		plotSymbols = nil;
+		decimation = CPScatterPlotDecimationNone;
+		decimatedPointFlags = nil;
+		decimatedXRange = nil;
+		decimatedYRange = nil;
+		decimatedBounds = CGRectZero;
 		self.needsDisplayOnBoundsChange = YES;
 	}
 	return self;
@@ -146,6 +178,9 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2);
 	[plotSymbol release];
 	[areaFill release];
 	[plotSymbols release];
+	[decimatedPointFlags release];
+	[decimatedXRange release];
+	[decimatedYRange release];
 	[xValuesTransformer release];
     [yValuesTransformer release];
     	
@@ -249,6 +284,7 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2);
 {	 
 	[super reloadData];
 	
+	[self invalidateDecimatedPointFlags];
 	self.xValues = nil;
 	self.yValues = nil;
 	self.plotSymbols = nil;
@@ -307,6 +343,80 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2);
 	}
 }
 
+-(void)insertDataAtIndex:(NSUInteger)index numberOfRecords:(NSUInteger)numberOfRecords
+{
+	// Bound values and per-record symbols are only loaded as a whole
+	if ( self.observedObjectForXValues || self.plotSymbols.count > 0 ) {
+		[self setDataNeedsReloading];
+		return;
+	}
+	
+	[self invalidateDecimatedPointFlags];
+	[super insertDataAtIndex:index numberOfRecords:numberOfRecords];
+}
+
+#pragma mark -
+#pragma mark Partial Redrawing
+
+-(void)setNeedsDisplayForRecordIndexRange:(NSRange)indexRange
+{
+	NSUInteger dataCount = self.cachedDataCount;
+	
+	// The line segment from the previous record changes too
+	NSUInteger firstIndex = (indexRange.location > 0 ? indexRange.location - 1 : 0);
+	NSUInteger endIndex = MIN(NSMaxRange(indexRange), dataCount);
+	if ( firstIndex >= endIndex ) {
+		[super setNeedsDisplayForRecordIndexRange:indexRange];
+		return;
+	}
+	
+	double minChangedX = INFINITY, maxChangedX = -INFINITY;
+	double minChangedY = INFINITY, maxChangedY = -INFINITY;
+	double minOtherY = INFINITY, maxOtherY = -INFINITY;
+	BOOL checksOtherRecords = (self.areaFill != nil);
+	
+	for ( NSUInteger i = (checksOtherRecords ? 0 : firstIndex); i < (checksOtherRecords ? dataCount : endIndex); i++ ) {
+		double x, y;
+		if ( self.doublePrecisionCache ) {
+			x = self.xDoubleValues[i];
+			y = self.yDoubleValues[i];
+		}
+		else {
+			x = [[self.xValues objectAtIndex:i] doubleValue];
+			y = [[self.yValues objectAtIndex:i] doubleValue];
+		}
+		if ( isnan(x) || isnan(y) ) continue;
+		
+		if ( i >= firstIndex && i < endIndex ) {
+			minChangedX = MIN(minChangedX, x);
+			maxChangedX = MAX(maxChangedX, x);
+			minChangedY = MIN(minChangedY, y);
+			maxChangedY = MAX(maxChangedY, y);
+		}
+		else {
+			minOtherY = MIN(minOtherY, y);
+			maxOtherY = MAX(maxOtherY, y);
+		}
+	}
+	
+	// Area fills are drawn across the bounding box of the whole fill path,
+	// so records that extend it change the fill everywhere
+	BOOL extendsFillBounds = checksOtherRecords && (minChangedY < minOtherY || maxChangedY > maxOtherY);
+	if ( minChangedX > maxChangedX || extendsFillBounds ) {
+		[super setNeedsDisplayForRecordIndexRange:indexRange];
+		return;
+	}
+	
+	CPPlotRange *changedXRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromDouble(minChangedX) length:CPDecimalFromDouble(maxChangedX - minChangedX)];
+	[self setNeedsDisplayInXRange:changedXRange yRange:nil];
+}
+
+-(CGFloat)dirtyRectOutset
+{
+	CGFloat symbolSize = MAX(self.plotSymbol.size.width, self.plotSymbol.size.height);
+	return ceil(self.dataLineStyle.lineWidth + symbolSize) + 1.0;
+}
+
 #pragma mark -
 #pragma mark Determing Which Points to Draw
 
@@ -431,6 +541,107 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2);
 	return result;
 }
 
+// Narrows the index range to the points needed to draw the given rect, keeping the nearest point
+// beyond each edge so that line segments crossing the edges are complete.
+// Indexes are left unchanged unless the x values never decrease.
+-(void)clipFirstDrawnPointIndex:(NSUInteger *)firstIndex lastDrawnPointIndex:(NSUInteger *)lastIndex forViewPoints:(CGPoint *)viewPoints toRect:(CGRect)rect
+{
+	CGFloat minX = CGRectGetMinX(rect);
+	CGFloat maxX = CGRectGetMaxX(rect);
+	CGFloat previousX = -INFINITY;
+	NSUInteger clippedFirstIndex = *firstIndex;
+	NSUInteger clippedLastIndex = *lastIndex;
+	BOOL foundLastIndex = NO;
+	
+	for ( NSUInteger i = *firstIndex; i <= *lastIndex; i++ ) {
+		CGFloat x = viewPoints[i].x;
+		if ( isnan(x) ) continue;
+		if ( x < previousX ) return;
+		previousX = x;
+		
+		if ( x < minX ) {
+			clippedFirstIndex = i;
+		}
+		if ( !foundLastIndex && x > maxX ) {
+			clippedLastIndex = i;
+			foundLastIndex = YES;
+		}
+	}
+	
+	*firstIndex = clippedFirstIndex;
+	*lastIndex = clippedLastIndex;
+}
+
+#pragma mark -
+#pragma mark Decimation
+
+-(void)calculateDecimatedPointFlags:(BOOL *)keepPointFlags forViewPoints:(CGPoint *)viewPoints drawPointFlags:(BOOL *)drawPointFlags
+{
+	NSUInteger dataCount = self.cachedDataCount;
+	if ( dataCount == 0 ) return;
+	memset(keepPointFlags, NO, dataCount * sizeof(BOOL));
+	
+	NSUInteger firstDrawnPointIndex = [self extremeDrawnPointIndexForFlags:drawPointFlags extremeNumIsLowerBound:YES];
+	NSUInteger lastDrawnPointIndex = [self extremeDrawnPointIndexForFlags:drawPointFlags extremeNumIsLowerBound:NO];
+	if ( firstDrawnPointIndex == NSNotFound ) return;
+	
+	// Consecutive points that fall in the same view column are stroked as one vertical run.
+	// Keeping the first, last, lowest and highest point of each run draws the same pixels.
+	NSUInteger runFirstIndex = firstDrawnPointIndex;
+	NSUInteger runMinIndex = firstDrawnPointIndex;
+	NSUInteger runMaxIndex = firstDrawnPointIndex;
+	CGFloat runColumn = floor(viewPoints[firstDrawnPointIndex].x);
+	for ( NSUInteger i = firstDrawnPointIndex + 1; i <= lastDrawnPointIndex; i++ ) {
+		CGPoint point = viewPoints[i];
+		CGFloat column = floor(point.x);
+		if ( column != runColumn ) {
+			keepPointFlags[runFirstIndex] = YES;
+			keepPointFlags[runMinIndex] = YES;
+			keepPointFlags[runMaxIndex] = YES;
+			keepPointFlags[i - 1] = YES;
+			runFirstIndex = i;
+			runMinIndex = i;
+			runMaxIndex = i;
+			runColumn = column;
+		}
+		else {
+			if ( point.y < viewPoints[runMinIndex].y ) runMinIndex = i;
+			if ( point.y > viewPoints[runMaxIndex].y ) runMaxIndex = i;
+		}
+	}
+	keepPointFlags[runFirstIndex] = YES;
+	keepPointFlags[runMinIndex] = YES;
+	keepPointFlags[runMaxIndex] = YES;
+	keepPointFlags[lastDrawnPointIndex] = YES;
+}
+
+-(BOOL *)decimatedPointFlagsForViewPoints:(CGPoint *)viewPoints drawPointFlags:(BOOL *)drawPointFlags
+{
+	NSUInteger dataCount = self.cachedDataCount;
+	CPXYPlotSpace *xyPlotSpace = (CPXYPlotSpace *)self.plotSpace;
+	CGRect currentBounds = self.bounds;
+	
+	BOOL cacheIsValid = ( self.decimatedPointFlags.length == dataCount * sizeof(BOOL) &&
+						  [self.decimatedXRange isEqualToRange:xyPlotSpace.xRange] &&
+						  [self.decimatedYRange isEqualToRange:xyPlotSpace.yRange] &&
+						  CGRectEqualToRect(decimatedBounds, currentBounds) );
+	if ( !cacheIsValid ) {
+		self.decimatedPointFlags = [NSMutableData dataWithLength:dataCount * sizeof(BOOL)];
+		[self calculateDecimatedPointFlags:[self.decimatedPointFlags mutableBytes] forViewPoints:viewPoints drawPointFlags:drawPointFlags];
+		self.decimatedXRange = xyPlotSpace.xRange;
+		self.decimatedYRange = xyPlotSpace.yRange;
+		decimatedBounds = currentBounds;
+	}
+	return [self.decimatedPointFlags mutableBytes];
+}
+
+-(void)invalidateDecimatedPointFlags
+{
+	self.decimatedPointFlags = nil;
+	self.decimatedXRange = nil;
+	self.decimatedYRange = nil;
+}
+
 #pragma mark -
 #pragma mark View Points
 
@@ -522,52 +733,86 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2)
 	if ( firstDrawnPointIndex != NSNotFound ) {
 		// Path
 		CGMutablePathRef dataLinePath = NULL;
-		if ( self.dataLineStyle || self.areaFill ) {
-			dataLinePath = CGPathCreateMutable();
-			CGPathMoveToPoint(dataLinePath, NULL, viewPoints[firstDrawnPointIndex].x, viewPoints[firstDrawnPointIndex].y);
-			NSUInteger i = firstDrawnPointIndex + 1;
-			while ( i <= lastDrawnPointIndex ) {
-				CGPathAddLineToPoint(dataLinePath, NULL, viewPoints[i].x, viewPoints[i].y);
-				i++;
-			} 
-		}
-        
-		// Draw fill
+		CGMutablePathRef fillPath = NULL;
 		NSDecimal temporaryAreaBaseValue = self.areaBaseValue;
-		if ( self.areaFill && (!NSDecimalIsNotANumber(&temporaryAreaBaseValue)) ) {	
-            id xValue;
-            if ( self.doublePrecisionCache ) {
-				xValue = [NSNumber numberWithDouble:self.xDoubleValues[firstDrawnPointIndex]];
-			}
-			else {
-				xValue = [self.xValues objectAtIndex:firstDrawnPointIndex];	
-			}
-			
-			CGPoint baseLinePoint;
+		BOOL drawsAreaFill = ( self.areaFill && (!NSDecimalIsNotANumber(&temporaryAreaBaseValue)) );
+		
+		CGFloat baseLineYValue = 0.0;
+		CGRect fillBounds = CGRectNull;
+		if ( drawsAreaFill ) {
 			NSDecimal plotPoint[2];
-			plotPoint[CPCoordinateX] = [xValue decimalValue];
+			plotPoint[CPCoordinateX] = ((CPXYPlotSpace *)self.plotSpace).xRange.location;
 			plotPoint[CPCoordinateY] = self.areaBaseValue;
-			baseLinePoint = [self convertPoint:[self.plotSpace plotAreaViewPointForPlotPoint:plotPoint] fromLayer:self.plotArea];
-			
-			CGFloat baseLineYValue = baseLinePoint.y;
+			CGPoint baseLinePoint = [self convertPoint:[self.plotSpace plotAreaViewPointForPlotPoint:plotPoint] fromLayer:self.plotArea];
+			baseLineYValue = baseLinePoint.y;
+			fillPath = CGPathCreateMutable();
 			
-			CGPoint baseViewPoint1 = viewPoints[lastDrawnPointIndex];
-			baseViewPoint1.y = baseLineYValue;
-			baseViewPoint1 = CPAlignPointToUserSpace(theContext, baseViewPoint1);
-			
-			CGPoint baseViewPoint2 = viewPoints[firstDrawnPointIndex];
-			baseViewPoint2.y = baseLineYValue;
-			baseViewPoint2 = CPAlignPointToUserSpace(theContext, baseViewPoint2);
-			
-			CGMutablePathRef fillPath = CGPathCreateMutableCopy(dataLinePath);
-			CGPathAddLineToPoint(fillPath, NULL, baseViewPoint1.x, baseViewPoint1.y);
-			CGPathAddLineToPoint(fillPath, NULL, baseViewPoint2.x, baseViewPoint2.y);
-			CGPathCloseSubpath(fillPath);
+			// The fill is laid out across every drawn point, so a partial redraw shades its strip
+			// exactly as a full redraw would.
+			for ( NSUInteger i = firstDrawnPointIndex; i <= lastDrawnPointIndex; i++ ) {
+				CGPoint viewPoint = viewPoints[i];
+				if ( isnan(viewPoint.x) || isnan(viewPoint.y) ) continue;
+				fillBounds = CGRectUnion(fillBounds, CGRectMake(viewPoint.x, viewPoint.y, 0.0, 0.0));
+			}
+			if ( !CGRectIsNull(fillBounds) ) {
+				CGPoint baseViewPoint = CPAlignPointToUserSpace(theContext, CGPointMake(CGRectGetMinX(fillBounds), baseLineYValue));
+				fillBounds = CGRectUnion(fillBounds, CGRectMake(CGRectGetMinX(fillBounds), baseViewPoint.y, 0.0, 0.0));
+			}
+		}
+		
+		// When only part of the layer is redrawn, skip the points that cannot touch it.
+		// The nearest point beyond each edge is kept, and each fill segment is closed to the
+		// baseline at its clipped ends, which lie outside the dirty rect.
+		CGRect dirtyRect = CGContextGetClipBoundingBox(theContext);
+		CGRect symbolDirtyRect = CGRectInset(dirtyRect, -self.dirtyRectOutset, -self.dirtyRectOutset);
+		if ( CGRectGetWidth(dirtyRect) < CGRectGetWidth(self.bounds) ) {
+			[self clipFirstDrawnPointIndex:&firstDrawnPointIndex lastDrawnPointIndex:&lastDrawnPointIndex forViewPoints:viewPoints toRect:dirtyRect];
+		}
+		if ( self.dataLineStyle || drawsAreaFill ) {
+			BOOL *keepPointFlags = NULL;
+			if ( self.decimation != CPScatterPlotDecimationNone ) {
+				keepPointFlags = [self decimatedPointFlagsForViewPoints:viewPoints drawPointFlags:drawPointFlags];
+			}
 			
+			// Gap points split the data line into segments that share one line path and one fill path
+			dataLinePath = CGPathCreateMutable();
+			CGMutablePathRef segmentPath = NULL;
+			NSUInteger segmentFirstIndex = NSNotFound;
+			NSUInteger segmentLastIndex = NSNotFound;
+			for ( NSUInteger i = firstDrawnPointIndex; i <= lastDrawnPointIndex; i++ ) {
+				CGPoint viewPoint = viewPoints[i];
+				if ( isnan(viewPoint.x) || isnan(viewPoint.y) ) {
+					if ( segmentPath ) {
+						[self addSegmentPath:segmentPath fromViewPoint:viewPoints[segmentFirstIndex] toViewPoint:viewPoints[segmentLastIndex] toDataLinePath:dataLinePath fillPath:fillPath baseLineYValue:baseLineYValue inContext:theContext];
+						CGPathRelease(segmentPath);
+						segmentPath = NULL;
+					}
+					continue;
+				}
+				if ( !segmentPath ) {
+					segmentPath = CGPathCreateMutable();
+					CGPathMoveToPoint(segmentPath, NULL, viewPoint.x, viewPoint.y);
+					segmentFirstIndex = i;
+				}
+				else if ( !keepPointFlags || keepPointFlags[i] ) {
+					CGPathAddLineToPoint(segmentPath, NULL, viewPoint.x, viewPoint.y);
+				}
+				segmentLastIndex = i;
+			}
+			if ( segmentPath ) {
+				[self addSegmentPath:segmentPath fromViewPoint:viewPoints[segmentFirstIndex] toViewPoint:viewPoints[segmentLastIndex] toDataLinePath:dataLinePath fillPath:fillPath baseLineYValue:baseLineYValue inContext:theContext];
+				CGPathRelease(segmentPath);
+			}
+		}
+        
+		// Draw fill
+		if ( fillPath ) {
+			CGContextSaveGState(theContext);
 			CGContextBeginPath(theContext);
 			CGContextAddPath(theContext, fillPath);
-			[self.areaFill fillPathInContext:theContext];
-			
+			CGContextClip(theContext);
+			[self.areaFill fillRect:fillBounds inContext:theContext];
+			CGContextRestoreGState(theContext);
 			CGPathRelease(fillPath);
 		}
 		
@@ -583,7 +828,8 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2)
 		// Draw plot symbols
 		if (self.plotSymbol || self.plotSymbols.count) {
 			for (NSUInteger i = 0; i < dataCount; i++) {
-				if ( drawPointFlags[i] ) {
+				// gap points are never contained in the rect
+				if ( drawPointFlags[i] && CGRectContainsPoint(symbolDirtyRect, viewPoints[i]) ) {
 					CPPlotSymbol *currentSymbol = self.plotSymbol;
 					if ( i < self.plotSymbols.count ) currentSymbol = [self.plotSymbols objectAtIndex:i];
 					if ( [currentSymbol isKindOfClass:[CPPlotSymbol class]] ) {
@@ -598,6 +844,25 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2)
 	free(drawPointFlags);
 }
 
+-(void)addSegmentPath:(CGPathRef)segmentPath fromViewPoint:(CGPoint)firstViewPoint toViewPoint:(CGPoint)lastViewPoint toDataLinePath:(CGMutablePathRef)dataLinePath fillPath:(CGMutablePathRef)fillPath baseLineYValue:(CGFloat)baseLineYValue inContext:(CGContextRef)theContext
+{
+	CGPathAddPath(dataLinePath, NULL, segmentPath);
+	if ( fillPath ) {
+		CGPoint baseViewPoint1 = lastViewPoint;
+		baseViewPoint1.y = baseLineYValue;
+		baseViewPoint1 = CPAlignPointToUserSpace(theContext, baseViewPoint1);
+		
+		CGPoint baseViewPoint2 = firstViewPoint;
+		baseViewPoint2.y = baseLineYValue;
+		baseViewPoint2 = CPAlignPointToUserSpace(theContext, baseViewPoint2);
+		
+		CGPathAddPath(fillPath, NULL, segmentPath);
+		CGPathAddLineToPoint(fillPath, NULL, baseViewPoint1.x, baseViewPoint1.y);
+		CGPathAddLineToPoint(fillPath, NULL, baseViewPoint2.x, baseViewPoint2.y);
+		CGPathCloseSubpath(fillPath);
+	}
+}
+
 #pragma mark -
 #pragma mark Fields
 
@@ -648,6 +913,15 @@ CGFloat squareOfDistanceBetweenPoints(CGPoint point1, CGPoint point2)
 	}
 }
 
+-(void)setDecimation:(CPScatterPlotDecimation)newDecimation
+{
+	if ( newDecimation != decimation ) {
+		decimation = newDecimation;
+		[self invalidateDecimatedPointFlags];
+		[self setNeedsDisplay];
+	}
+}
+
 -(void)setAreaBaseValue:(NSDecimal)newAreaBaseValue
 {
 	if (CPDecimalEquals(areaBaseValue, newAreaBaseValue))
@@ -7,9 +7,60 @@
 -(void)calculatePointsToDraw:(BOOL *)pointDrawFlags forPlotSpace:(CPXYPlotSpace *)aPlotSpace includeVisiblePointsOnly:(BOOL)visibleOnly;
 -(void)setXValues:(NSArray *)newValues;
 -(void)setYValues:(NSArray *)newValues;
+-(void)calculateDecimatedPointFlags:(BOOL *)keepPointFlags forViewPoints:(CGPoint *)viewPoints drawPointFlags:(BOOL *)drawPointFlags;
+-(void)clipFirstDrawnPointIndex:(NSUInteger *)firstIndex lastDrawnPointIndex:(NSUInteger *)lastIndex forViewPoints:(CGPoint *)viewPoints toRect:(CGRect)rect;
 
 @end
 
+#pragma mark -
+
+@interface CPScatterPlotTestDataSource : NSObject <CPPlotDataSource> {
+	NSMutableArray *xValues;
+	NSMutableArray *yValues;
+}
+
+-(void)insertXValue:(double)x yValue:(double)y atIndex:(NSUInteger)index;
+
+@end
+
+@implementation CPScatterPlotTestDataSource
+
+-(id)init
+{
+	if ( self = [super init] ) {
+		xValues = [[NSMutableArray alloc] init];
+		yValues = [[NSMutableArray alloc] init];
+	}
+	return self;
+}
+
+-(void)dealloc
+{
+	[xValues release];
+	[yValues release];
+	[super dealloc];
+}
+
+-(void)insertXValue:(double)x yValue:(double)y atIndex:(NSUInteger)index
+{
+	[xValues insertObject:[NSNumber numberWithDouble:x] atIndex:index];
+	[yValues insertObject:[NSNumber numberWithDouble:y] atIndex:index];
+}
+
+-(NSUInteger)numberOfRecordsForPlot:(CPPlot *)plot
+{
+	return xValues.count;
+}
+
+-(NSArray *)numbersForPlot:(CPPlot *)plot field:(NSUInteger)fieldEnum recordIndexRange:(NSRange)indexRange
+{
+	NSArray *values = (fieldEnum == CPScatterPlotFieldX ? xValues : yValues);
+	return [values subarrayWithRange:indexRange];
+}
+
+@end
+
+#pragma mark -
 
 @implementation CPScatterPlotTests
 
@@ -189,4 +240,107 @@
     }
 }
 
+-(void)testDecimationKeepsColumnExtremes
+{
+	BOOL drawFlags[7] = {YES, YES, YES, YES, YES, YES, YES};
+	BOOL keepFlags[7];
+	CGPoint viewPoints[7] = {{0.1, 5.0}, {0.2, 1.0}, {0.3, 9.0}, {0.4, 3.0}, {0.5, 4.0}, {0.6, 2.0}, {3.0, 6.0}};
+	BOOL expected[7] = {YES, YES, YES, NO, NO, YES, YES};
+	NSMutableArray *values = [NSMutableArray array];
+    for ( NSUInteger i = 0; i < 7; i++ ) [values addObject:[NSNumber numberWithDouble:viewPoints[i].x]];
+	[self.plot setXValues:values];
+	[self.plot calculateDecimatedPointFlags:keepFlags forViewPoints:viewPoints drawPointFlags:drawFlags];
+    for ( NSUInteger i = 0; i < 7; i++ ) {
+		if ( expected[i] ) {
+			STAssertTrue(keepFlags[i], @"Test that the first, last, minimum and maximum points of a column are kept (%lu).", (unsigned long)i);
+		}
+		else {
+			STAssertFalse(keepFlags[i], @"Test that interior points of a column are dropped (%lu).", (unsigned long)i);
+		}
+    }
+}
+
+-(void)testDecimationKeepsOnePointPerColumn
+{
+	BOOL drawFlags[4] = {YES, YES, YES, YES};
+	BOOL keepFlags[4];
+	CGPoint viewPoints[4] = {{0.5, 1.0}, {1.5, 2.0}, {2.5, 3.0}, {3.5, 4.0}};
+	NSMutableArray *values = [NSMutableArray array];
+    for ( NSUInteger i = 0; i < 4; i++ ) [values addObject:[NSNumber numberWithDouble:viewPoints[i].x]];
+	[self.plot setXValues:values];
+	[self.plot calculateDecimatedPointFlags:keepFlags forViewPoints:viewPoints drawPointFlags:drawFlags];
+    for ( NSUInteger i = 0; i < 4; i++ ) {
+		STAssertTrue(keepFlags[i], @"Test that points in separate columns are never dropped (%lu).", (unsigned long)i);
+    }
+}
+
+-(void)testDecimationKeepsPointsAroundGaps
+{
+	BOOL drawFlags[5] = {YES, YES, YES, YES, YES};
+	BOOL keepFlags[5];
+	CGPoint viewPoints[5] = {{0.1, 1.0}, {0.2, 2.0}, {NAN, NAN}, {0.3, 3.0}, {0.4, 4.0}};
+	NSMutableArray *values = [NSMutableArray array];
+    for ( NSUInteger i = 0; i < 5; i++ ) [values addObject:[NSNumber numberWithDouble:viewPoints[i].x]];
+	[self.plot setXValues:values];
+	[self.plot calculateDecimatedPointFlags:keepFlags forViewPoints:viewPoints drawPointFlags:drawFlags];
+    for ( NSUInteger i = 0; i < 5; i++ ) {
+		STAssertTrue(keepFlags[i], @"Test that the ends of segments either side of a gap are kept (%lu).", (unsigned long)i);
+    }
+}
+
+-(void)testClipDrawnPointIndexesKeepsPointsBeyondEdges
+{
+	CGPoint viewPoints[6] = {{0.0, 1.0}, {10.0, 1.0}, {20.0, 1.0}, {30.0, 1.0}, {40.0, 1.0}, {50.0, 1.0}};
+	NSUInteger firstIndex = 0;
+	NSUInteger lastIndex = 5;
+	[self.plot clipFirstDrawnPointIndex:&firstIndex lastDrawnPointIndex:&lastIndex forViewPoints:viewPoints toRect:CGRectMake(15.0, 0.0, 10.0, 10.0)];
+	STAssertEquals(firstIndex, (NSUInteger)1, @"Test that the last point before the rect is kept.");
+	STAssertEquals(lastIndex, (NSUInteger)3, @"Test that the first point after the rect is kept.");
+}
+
+-(void)testClipDrawnPointIndexesIgnoresUnorderedPoints
+{
+	CGPoint viewPoints[4] = {{0.0, 1.0}, {30.0, 1.0}, {10.0, 1.0}, {40.0, 1.0}};
+	NSUInteger firstIndex = 0;
+	NSUInteger lastIndex = 3;
+	[self.plot clipFirstDrawnPointIndex:&firstIndex lastDrawnPointIndex:&lastIndex forViewPoints:viewPoints toRect:CGRectMake(15.0, 0.0, 10.0, 10.0)];
+	STAssertEquals(firstIndex, (NSUInteger)0, @"Test that unordered points are not clipped.");
+	STAssertEquals(lastIndex, (NSUInteger)3, @"Test that unordered points are not clipped.");
+}
+
+-(void)testInsertDataExtendsCachedValues
+{
+	CPScatterPlotTestDataSource *dataSource = [[[CPScatterPlotTestDataSource alloc] init] autorelease];
+	for ( NSUInteger i = 0; i < 5; i++ ) [dataSource insertXValue:i yValue:0.1 * i atIndex:i];
+	self.plot.dataSource = dataSource;
+	[self.plot reloadData];
+	STAssertEquals(self.plot.cachedDataCount, (NSUInteger)5, @"Test that all records are loaded.");
+	
+	[dataSource insertXValue:5.0 yValue:0.5 atIndex:5];
+	[dataSource insertXValue:6.0 yValue:0.6 atIndex:6];
+	[self.plot appendRecords:2];
+	STAssertFalse(self.plot.dataNeedsReloading, @"Test that appending does not force a reload.");
+	STAssertEquals(self.plot.cachedDataCount, (NSUInteger)7, @"Test that appended records are cached.");
+	STAssertEquals([[[self.plot cachedNumbersForField:CPScatterPlotFieldY] objectAtIndex:6] doubleValue], 0.6, @"Test that appended values are cached in order.");
+	
+	[dataSource insertXValue:-1.0 yValue:0.9 atIndex:0];
+	[self.plot insertDataAtIndex:0 numberOfRecords:1];
+	STAssertEquals(self.plot.cachedDataCount, (NSUInteger)8, @"Test that inserted records are cached.");
+	STAssertEquals([[[self.plot cachedNumbersForField:CPScatterPlotFieldX] objectAtIndex:0] doubleValue], -1.0, @"Test that inserted values are cached at the insertion index.");
+	STAssertEquals([[[self.plot cachedNumbersForField:CPScatterPlotFieldX] objectAtIndex:1] doubleValue], 0.0, @"Test that existing values move past the insertion index.");
+}
+
+-(void)testInsertDataReloadsWhenCacheIsOutOfStep
+{
+	CPScatterPlotTestDataSource *dataSource = [[[CPScatterPlotTestDataSource alloc] init] autorelease];
+	for ( NSUInteger i = 0; i < 5; i++ ) [dataSource insertXValue:i yValue:0.1 * i atIndex:i];
+	self.plot.dataSource = dataSource;
+	[self.plot reloadData];
+	
+	[dataSource insertXValue:5.0 yValue:0.5 atIndex:5];
+	[dataSource insertXValue:6.0 yValue:0.6 atIndex:6];
+	[self.plot appendRecords:1];
+	STAssertTrue(self.plot.dataNeedsReloading, @"Test that a record count mismatch forces a full reload.");
+}
+
 @end
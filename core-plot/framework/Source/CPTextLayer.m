@@ -1,6 +1,7 @@
 
 #import "CPTextLayer.h"
 #import "CPTextStyle.h"
+#import "CPTextLayoutCache.h"
 #import "CPPlatformSpecificFunctions.h"
 #import "CPColor.h"
 #import "CPColorSpace.h"
@@ -65,7 +66,8 @@ const CGFloat kCPTextLayerMarginWidth = 1.0;
 
 -(void)setText:(NSString *)newValue
 {
-	if ( text != newValue ) {
+	// Relabeling often assigns the same string again; skip the resize and redraw
+	if ( text != newValue && ![text isEqualToString:newValue] ) {
 		[text release];
 		text = [newValue copy];
 		[self sizeToFit];
@@ -85,11 +87,12 @@ const CGFloat kCPTextLayerMarginWidth = 1.0;
 #pragma mark Layout
 
 /**	@brief Resizes the layer to fit its contents leaving a narrow margin on all four sides.
+ *	Text measurements are shared through the CPTextLayoutCache.
  **/
 -(void)sizeToFit
 {	
 	if ( self.text == nil ) return;
-	CGSize textSize = [self.text sizeWithTextStyle:textStyle];
+	CGSize textSize = [[CPTextLayoutCache sharedCache] sizeOfText:self.text withTextStyle:textStyle];
 
 	// Add small margin
 	textSize.width += 2 * kCPTextLayerMarginWidth;
@@ -0,0 +1,34 @@
+#import <Foundation/Foundation.h>
+#import <QuartzCore/QuartzCore.h>
+
+@class CPTextStyle;
+@class _CPTextLayoutCacheEntry;
+
+@interface CPTextLayoutCache : NSObject {
+	@private
+	NSUInteger countLimit;
+	NSMutableDictionary *entries;
+	_CPTextLayoutCacheEntry *leastRecentlyUsedEntry;
+	_CPTextLayoutCacheEntry *mostRecentlyUsedEntry;
+}
+
+@property (nonatomic, readwrite, assign) NSUInteger countLimit;
+@property (nonatomic, readonly, assign) NSUInteger count;
+
+/// @name Factory Methods
+/// @{
++(CPTextLayoutCache *)sharedCache;
+///	@}
+
+/// @name Measurement
+/// @{
+-(CGSize)sizeOfText:(NSString *)text withTextStyle:(CPTextStyle *)style;
+-(CGSize)measureText:(NSString *)text withTextStyle:(CPTextStyle *)style;
+///	@}
+
+/// @name Eviction
+/// @{
+-(void)removeAllEntries;
+///	@}
+
+@end
@@ -0,0 +1,225 @@
+#import "CPTextLayoutCache.h"
+#import "CPTextStyle.h"
+
+static const NSUInteger kCPTextLayoutCacheDefaultCountLimit = 256;
+
+///	@cond
+// A cached measurement. Entries are owned by the cache dictionary and linked
+// from least to most recently used, so a hit moves its entry in constant time.
+@interface _CPTextLayoutCacheEntry : NSObject {
+	@public
+	NSString *key;
+	CGSize size;
+	_CPTextLayoutCacheEntry *previousEntry;
+	_CPTextLayoutCacheEntry *nextEntry;
+}
+
+@end
+
+@implementation _CPTextLayoutCacheEntry
+
+-(void)dealloc
+{
+	[key release];
+	[super dealloc];
+}
+
+@end
+
+@interface CPTextLayoutCache ()
+
+-(NSString *)keyForText:(NSString *)text textStyle:(CPTextStyle *)style;
+-(void)unlinkEntry:(_CPTextLayoutCacheEntry *)entry;
+-(void)linkMostRecentlyUsedEntry:(_CPTextLayoutCacheEntry *)entry;
+-(void)evictEntriesBeyondLimit;
+
+@end
+///	@endcond
+
+/** @brief A least-recently-used cache of measured text sizes.
+ *
+ *	Text layers measure their text every time the text or style changes. Axes relabel often,
+ *	usually with strings they have drawn before, so the measurements are cached by string,
+ *	font name, and font size. The color of a text style does not affect its measurement.
+ *	When more than countLimit entries are stored, the least recently used ones are discarded.
+ **/
+@implementation CPTextLayoutCache
+
+/** @property countLimit
+ *  @brief The maximum number of measurements kept. Defaults to 256.
+ **/
+@synthesize countLimit;
+
+/** @property count
+ *  @brief The number of measurements currently cached.
+ **/
+@dynamic count;
+
+#pragma mark -
+#pragma mark Class methods
+
+/** @brief Returns the cache shared by all text layers.
+ *  @return The shared CPTextLayoutCache object.
+ **/
++(CPTextLayoutCache *)sharedCache
+{
+	static CPTextLayoutCache *sharedCache = nil;
+	@synchronized ( [CPTextLayoutCache class] ) {
+		if ( !sharedCache ) {
+			sharedCache = [[CPTextLayoutCache alloc] init];
+		}
+	}
+	return sharedCache;
+}
+
+#pragma mark -
+#pragma mark Init/Dealloc
+
+-(id)init
+{
+	if ( self = [super init] ) {
+		countLimit = kCPTextLayoutCacheDefaultCountLimit;
+		entries = [[NSMutableDictionary alloc] init];
+		leastRecentlyUsedEntry = nil;
+		mostRecentlyUsedEntry = nil;
+	}
+	return self;
+}
+
+-(void)dealloc
+{
+	[entries release];
+	[super dealloc];
+}
+
+#pragma mark -
+#pragma mark Measurement
+
+/**	@brief Determines the size of text drawn with the given style, measuring it only if it is not cached.
+ *	@param text The text to measure.
+ *	@param style The text style.
+ *	@return The size of the text when drawn with the given style.
+ **/
+-(CGSize)sizeOfText:(NSString *)text withTextStyle:(CPTextStyle *)style
+{
+	if ( text == nil ) return CGSizeZero;
+	
+	NSString *key = [self keyForText:text textStyle:style];
+	CGSize textSize;
+	
+	@synchronized ( self ) {
+		_CPTextLayoutCacheEntry *entry = [entries objectForKey:key];
+		if ( entry ) {
+			textSize = entry->size;
+			
+			// Move the entry to the most recently used end
+			[self unlinkEntry:entry];
+			[self linkMostRecentlyUsedEntry:entry];
+		}
+		else {
+			textSize = [self measureText:text withTextStyle:style];
+			entry = [[_CPTextLayoutCacheEntry alloc] init];
+			entry->key = [key copy];
+			entry->size = textSize;
+			[entries setObject:entry forKey:key];
+			[self linkMostRecentlyUsedEntry:entry];
+			[entry release];
+			[self evictEntriesBeyondLimit];
+		}
+	}
+	
+	return textSize;
+}
+
+/**	@brief Measures text that is not in the cache.
+ *	Subclasses can override this method to change how text is measured.
+ *	@param text The text to measure.
+ *	@param style The text style.
+ *	@return The size of the text when drawn with the given style.
+ **/
+-(CGSize)measureText:(NSString *)text withTextStyle:(CPTextStyle *)style
+{
+	return [text sizeWithTextStyle:style];
+}
+
+#pragma mark -
+#pragma mark Eviction
+
+/**	@brief Removes all cached measurements.
+ **/
+-(void)removeAllEntries
+{
+	@synchronized ( self ) {
+		leastRecentlyUsedEntry = nil;
+		mostRecentlyUsedEntry = nil;
+		[entries removeAllObjects];
+	}
+}
+
+-(void)evictEntriesBeyondLimit
+{
+	while ( entries.count > countLimit ) {
+		_CPTextLayoutCacheEntry *entry = [[leastRecentlyUsedEntry retain] autorelease];
+		[self unlinkEntry:entry];
+		[entries removeObjectForKey:entry->key];
+	}
+}
+
+#pragma mark -
+#pragma mark Accessors
+
+-(void)setCountLimit:(NSUInteger)newLimit
+{
+	@synchronized ( self ) {
+		countLimit = newLimit;
+		[self evictEntriesBeyondLimit];
+	}
+}
+
+-(NSUInteger)count
+{
+	@synchronized ( self ) {
+		return entries.count;
+	}
+}
+
+#pragma mark -
+#pragma mark Private Methods
+
+-(NSString *)keyForText:(NSString *)text textStyle:(CPTextStyle *)style
+{
+	return [NSString stringWithFormat:@"%@\t%g\t%@", style.fontName, (double)style.fontSize, text];
+}
+
+-(void)unlinkEntry:(_CPTextLayoutCacheEntry *)entry
+{
+	if ( entry->previousEntry ) {
+		entry->previousEntry->nextEntry = entry->nextEntry;
+	}
+	else {
+		leastRecentlyUsedEntry = entry->nextEntry;
+	}
+	if ( entry->nextEntry ) {
+		entry->nextEntry->previousEntry = entry->previousEntry;
+	}
+	else {
+		mostRecentlyUsedEntry = entry->previousEntry;
+	}
+	entry->previousEntry = nil;
+	entry->nextEntry = nil;
+}
+
+-(void)linkMostRecentlyUsedEntry:(_CPTextLayoutCacheEntry *)entry
+{
+	entry->previousEntry = mostRecentlyUsedEntry;
+	entry->nextEntry = nil;
+	if ( mostRecentlyUsedEntry ) {
+		mostRecentlyUsedEntry->nextEntry = entry;
+	}
+	else {
+		leastRecentlyUsedEntry = entry;
+	}
+	mostRecentlyUsedEntry = entry;
+}
+
+@end
@@ -0,0 +1,7 @@
+#import "CPTestCase.h"
+
+@interface CPTextLayoutCacheTests : CPTestCase {
+
+}
+
+@end
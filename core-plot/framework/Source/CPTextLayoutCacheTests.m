@@ -0,0 +1,112 @@
+#import "CPTextLayoutCache.h"
+#import "CPTextLayoutCacheTests.h"
+#import "CPTextStyle.h"
+
+// Records the text it is asked to measure.
+@interface _CPRecordingTextLayoutCache : CPTextLayoutCache {
+	NSMutableArray *measuredTexts;
+}
+
+@property (nonatomic, readonly, retain) NSMutableArray *measuredTexts;
+
+@end
+
+@implementation _CPRecordingTextLayoutCache
+
+@synthesize measuredTexts;
+
+-(id)init
+{
+	if ( self = [super init] ) {
+		measuredTexts = [[NSMutableArray alloc] init];
+	}
+	return self;
+}
+
+-(void)dealloc
+{
+	[measuredTexts release];
+	[super dealloc];
+}
+
+-(CGSize)measureText:(NSString *)text withTextStyle:(CPTextStyle *)style
+{
+	[measuredTexts addObject:text];
+	return [super measureText:text withTextStyle:style];
+}
+
+@end
+
+@implementation CPTextLayoutCacheTests
+
+-(void)testCachedSizeMatchesMeasuredSize
+{
+	CPTextLayoutCache *cache = [[[CPTextLayoutCache alloc] init] autorelease];
+	CPTextStyle *textStyle = [CPTextStyle textStyle];
+	
+	CGSize measuredSize = [@"1.25" sizeWithTextStyle:textStyle];
+	CGSize firstSize = [cache sizeOfText:@"1.25" withTextStyle:textStyle];
+	CGSize cachedSize = [cache sizeOfText:@"1.25" withTextStyle:textStyle];
+	
+	STAssertTrue(CGSizeEqualToSize(measuredSize, firstSize), @"First lookup should measure the text");
+	STAssertTrue(CGSizeEqualToSize(measuredSize, cachedSize), @"Cached size should match the measured size");
+	STAssertEquals(cache.count, (NSUInteger)1, @"Repeated lookups should share one entry");
+}
+
+-(void)testFontSizeIsPartOfKey
+{
+	CPTextLayoutCache *cache = [[[CPTextLayoutCache alloc] init] autorelease];
+	CPTextStyle *smallStyle = [CPTextStyle textStyle];
+	CPTextStyle *largeStyle = [CPTextStyle textStyle];
+	largeStyle.fontSize = 24.0;
+	
+	CGSize smallSize = [cache sizeOfText:@"100" withTextStyle:smallStyle];
+	CGSize largeSize = [cache sizeOfText:@"100" withTextStyle:largeStyle];
+	
+	STAssertEquals(cache.count, (NSUInteger)2, @"Different font sizes should be cached separately");
+	STAssertTrue(largeSize.width > smallSize.width, @"Larger font should measure wider");
+}
+
+-(void)testLeastRecentlyUsedEntryIsEvicted
+{
+	CPTextLayoutCache *cache = [[[CPTextLayoutCache alloc] init] autorelease];
+	cache.countLimit = 2;
+	CPTextStyle *textStyle = [CPTextStyle textStyle];
+	
+	[cache sizeOfText:@"1" withTextStyle:textStyle];
+	[cache sizeOfText:@"2" withTextStyle:textStyle];
+	[cache sizeOfText:@"1" withTextStyle:textStyle];
+	[cache sizeOfText:@"3" withTextStyle:textStyle];
+	
+	STAssertEquals(cache.count, (NSUInteger)2, @"Cache should not grow beyond its limit");
+	
+	cache.countLimit = 1;
+	STAssertEquals(cache.count, (NSUInteger)1, @"Lowering the limit should evict entries");
+	
+	[cache removeAllEntries];
+	STAssertEquals(cache.count, (NSUInteger)0, @"All entries should be removed");
+}
+
+-(void)testTouchedEntryOutlivesOlderEntries
+{
+	_CPRecordingTextLayoutCache *cache = [[[_CPRecordingTextLayoutCache alloc] init] autorelease];
+	cache.countLimit = 3;
+	CPTextStyle *textStyle = [CPTextStyle textStyle];
+	
+	[cache sizeOfText:@"1" withTextStyle:textStyle];
+	[cache sizeOfText:@"2" withTextStyle:textStyle];
+	[cache sizeOfText:@"3" withTextStyle:textStyle];
+	[cache sizeOfText:@"1" withTextStyle:textStyle];
+	[cache sizeOfText:@"4" withTextStyle:textStyle];
+	
+	[cache.measuredTexts removeAllObjects];
+	[cache sizeOfText:@"1" withTextStyle:textStyle];
+	[cache sizeOfText:@"3" withTextStyle:textStyle];
+	[cache sizeOfText:@"4" withTextStyle:textStyle];
+	[cache sizeOfText:@"2" withTextStyle:textStyle];
+	
+	NSArray *expectedTexts = [NSArray arrayWithObject:@"2"];
+	STAssertEqualObjects(cache.measuredTexts, expectedTexts, @"Only the least recently used entry should have been evicted");
+}
+
+@end
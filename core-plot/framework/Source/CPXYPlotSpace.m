@@ -201,6 +201,13 @@
 
 -(CGPoint)plotAreaViewPointForPlotPoint:(NSDecimal *)plotPoint
 {
+	if ( self.doublePrecisionArithmetic ) {
+		double doublePrecisionPlotPoint[2];
+		doublePrecisionPlotPoint[CPCoordinateX] = CPDecimalDoubleValue(plotPoint[CPCoordinateX]);
+		doublePrecisionPlotPoint[CPCoordinateY] = CPDecimalDoubleValue(plotPoint[CPCoordinateY]);
+		return [self plotAreaViewPointForDoublePrecisionPlotPoint:doublePrecisionPlotPoint];
+	}
+	
 	CGFloat viewX = 0.0, viewY = 0.0;
 	CGSize layerSize = self.graph.plotAreaFrame.plotArea.bounds.size;
 	
@@ -249,6 +256,14 @@
 
 -(void)plotPoint:(NSDecimal *)plotPoint forPlotAreaViewPoint:(CGPoint)point
 {
+	if ( self.doublePrecisionArithmetic ) {
+		double doublePrecisionPlotPoint[2];
+		[self doublePrecisionPlotPoint:doublePrecisionPlotPoint forPlotAreaViewPoint:point];
+		plotPoint[CPCoordinateX] = CPDecimalFromDouble(doublePrecisionPlotPoint[CPCoordinateX]);
+		plotPoint[CPCoordinateY] = CPDecimalFromDouble(doublePrecisionPlotPoint[CPCoordinateY]);
+		return;
+	}
+	
 	NSDecimal pointx = CPDecimalFromDouble(point.x);
 	NSDecimal pointy = CPDecimalFromDouble(point.y);
 	CGSize boundsSize = self.graph.plotAreaFrame.plotArea.bounds.size;
@@ -279,7 +294,20 @@
 
 -(void)doublePrecisionPlotPoint:(double *)plotPoint forPlotAreaViewPoint:(CGPoint)point 
 {
-	//	TODO: implement doublePrecisionPlotPoint:forViewPoint:
+	CGSize boundsSize = self.graph.plotAreaFrame.plotArea.bounds.size;
+	
+	double x = xRange.locationDouble;
+	if ( boundsSize.width != 0.0 ) {
+		x += (point.x / boundsSize.width) * xRange.lengthDouble;
+	}
+	
+	double y = yRange.locationDouble;
+	if ( boundsSize.height != 0.0 ) {
+		y += (point.y / boundsSize.height) * yRange.lengthDouble;
+	}
+	
+	plotPoint[CPCoordinateX] = x;
+	plotPoint[CPCoordinateY] = y;
 }
 
 #pragma mark -
@@ -77,4 +77,82 @@
 	STAssertTrue(CPDecimalEquals(plotPoint[CPCoordinateY], CPDecimalFromDouble(5.0)), errMessage);
 }
 
+-(void)testDoublePrecisionViewPointForPlotPoint
+{
+	CPXYPlotSpace *plotSpace = (CPXYPlotSpace *)self.graph.defaultPlotSpace;
+	plotSpace.doublePrecisionArithmetic = YES;
+	
+    plotSpace.xRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromDouble(0.0) 
+                                                        length:CPDecimalFromDouble(10.0)];
+    plotSpace.yRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromDouble(0.0) 
+                                                        length:CPDecimalFromDouble(5.0)];
+    
+    NSDecimal plotPoint[2];
+	plotPoint[CPCoordinateX] = CPDecimalFromDouble(5.0);
+	plotPoint[CPCoordinateY] = CPDecimalFromDouble(5.0);
+    
+    CGPoint viewPoint = [plotSpace plotAreaViewPointForPlotPoint:plotPoint];
+    
+    STAssertEqualsWithAccuracy(viewPoint.x, (CGFloat)50.0, (CGFloat)0.01, @"");
+    STAssertEqualsWithAccuracy(viewPoint.y, (CGFloat)50.0, (CGFloat)0.01, @"");
+}
+
+-(void)testDoublePrecisionPlotPointForViewPoint 
+{
+	CPXYPlotSpace *plotSpace = (CPXYPlotSpace *)self.graph.defaultPlotSpace;
+	
+    plotSpace.xRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromDouble(0.0) 
+                                                        length:CPDecimalFromDouble(10.0)];
+    plotSpace.yRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromDouble(0.0) 
+                                                        length:CPDecimalFromDouble(10.0)];
+	
+    double plotPoint[2];
+    CGPoint viewPoint = CGPointMake(50.0, 25.0);
+	
+	[plotSpace doublePrecisionPlotPoint:plotPoint forPlotAreaViewPoint:viewPoint];
+	
+	STAssertEqualsWithAccuracy(plotPoint[CPCoordinateX], 5.0, 0.0001, @"");
+	STAssertEqualsWithAccuracy(plotPoint[CPCoordinateY], 5.0, 0.0001, @"");
+	
+	plotSpace.doublePrecisionArithmetic = YES;
+	NSDecimal decimalPlotPoint[2];
+	[plotSpace plotPoint:decimalPlotPoint forPlotAreaViewPoint:viewPoint];
+	
+	STAssertEqualsWithAccuracy(CPDecimalDoubleValue(decimalPlotPoint[CPCoordinateX]), 5.0, 0.0001, @"");
+	STAssertEqualsWithAccuracy(CPDecimalDoubleValue(decimalPlotPoint[CPCoordinateY]), 5.0, 0.0001, @"");
+}
+
+-(void)testDoublePrecisionMappingIsFaster
+{
+	CPXYPlotSpace *plotSpace = (CPXYPlotSpace *)self.graph.defaultPlotSpace;
+	
+    plotSpace.xRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromDouble(1.0) 
+                                                        length:CPDecimalFromDouble(366.0)];
+    plotSpace.yRange = [CPPlotRange plotRangeWithLocation:CPDecimalFromDouble(0.0) 
+                                                        length:CPDecimalFromDouble(4.0)];
+	
+	const NSUInteger iterations = 10000;
+	NSTimeInterval elapsed[2];
+	CGPoint lastViewPoint[2];
+	for ( NSUInteger pass = 0; pass < 2; pass++ ) {
+		plotSpace.doublePrecisionArithmetic = (pass == 1);
+		
+		NSDate *start = [NSDate date];
+		for ( NSUInteger i = 0; i < iterations; i++ ) {
+			NSDecimal plotPoint[2];
+			plotPoint[CPCoordinateX] = CPDecimalFromUnsignedInteger(i % 366 + 1);
+			plotPoint[CPCoordinateY] = CPDecimalFromDouble(0.5);
+			lastViewPoint[pass] = [plotSpace plotAreaViewPointForPlotPoint:plotPoint];
+			
+			NSDecimal roundTripPoint[2];
+			[plotSpace plotPoint:roundTripPoint forPlotAreaViewPoint:lastViewPoint[pass]];
+		}
+		elapsed[pass] = -[start timeIntervalSinceNow];
+	}
+	
+	NSLog(@"%lu plot point conversions: NSDecimal %.1f ms, double %.1f ms", (unsigned long)iterations, elapsed[0] * 1000.0, elapsed[1] * 1000.0);
+	STAssertEqualsWithAccuracy(lastViewPoint[1].x, lastViewPoint[0].x, (CGFloat)0.01, @"");
+	STAssertEqualsWithAccuracy(lastViewPoint[1].y, lastViewPoint[0].y, (CGFloat)0.01, @"");
+}
+
 @end